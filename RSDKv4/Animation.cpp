@@ -3,6 +3,16 @@
 AnimationFile animationFileList[ANIFILE_COUNT];
 int animationFileCount = 0;
 
+#if !RETRO_USE_ORIGINAL_CODE
+#define ANIFILEINDEX_SIZE (0x200)
+
+// open addressed, from a file name's StrHash to its animationFileList slot (+1, 0 being empty), cleared with the list
+uint animFileIndexHash[ANIFILEINDEX_SIZE];
+short animFileIndexSlot[ANIFILEINDEX_SIZE];
+// every slot below it is in use, files are only added to the first free slot so it only ever moves forward until the list's cleared
+int firstFreeAnimFile = 0;
+#endif
+
 SpriteFrame scriptFrames[SPRITEFRAME_COUNT];
 int scriptFrameCount = 0;
 
@@ -103,6 +113,10 @@ void ClearAnimationData()
     for (int h = 0; h < HITBOX_COUNT; ++h) MEM_ZERO(hitboxList[h]);
     for (int a = 0; a < ANIMATION_COUNT; ++a) MEM_ZERO(animationList[a]);
     for (int a = 0; a < ANIFILE_COUNT; ++a) MEM_ZERO(animationFileList[a]);
+#if !RETRO_USE_ORIGINAL_CODE
+    memset(animFileIndexSlot, 0, sizeof(animFileIndexSlot));
+    firstFreeAnimFile = 0;
+#endif
 
     scriptFrameCount   = 0;
     animFrameCount     = 0;
@@ -121,6 +135,34 @@ AnimationFile *AddAnimationFile(char *filePath)
     StrCopy(path, "Data/Animations/");
     StrAdd(path, filePath);
 
+#if !RETRO_USE_ORIGINAL_CODE
+    // files are only ever added to the first free slot & the list is cleared all at once, so the index never goes stale
+    // a miss loads into the first free slot, the slot the search below would've stopped at
+    uint hash = StrHash(filePath);
+    int entry = 0;
+    for (int i = 0; i < ANIFILEINDEX_SIZE; ++i) {
+        entry = (hash + i) & (ANIFILEINDEX_SIZE - 1);
+        if (!animFileIndexSlot[entry])
+            break;
+        int a = animFileIndexSlot[entry] - 1;
+        if (animFileIndexHash[entry] == hash && a < firstFreeAnimFile && StrComp(animationFileList[a].fileName, filePath))
+            return &animationFileList[a];
+    }
+
+    while (firstFreeAnimFile < ANIFILE_COUNT && StrLength(animationFileList[firstFreeAnimFile].fileName) > 0) ++firstFreeAnimFile;
+    if (firstFreeAnimFile == ANIFILE_COUNT)
+        return NULL;
+
+    int a = firstFreeAnimFile;
+    StrCopy(animationFileList[a].fileName, filePath);
+    LoadAnimationFile(path);
+    ++animationFileCount;
+    if (StrLength(filePath) > 0 && !animFileIndexSlot[entry]) {
+        animFileIndexHash[entry] = hash;
+        animFileIndexSlot[entry] = a + 1;
+    }
+    return &animationFileList[a];
+#else
     for (int a = 0; a < 0x100; ++a) {
         if (StrLength(animationFileList[a].fileName) <= 0) {
             StrCopy(animationFileList[a].fileName, filePath);
@@ -132,6 +174,7 @@ AnimationFile *AddAnimationFile(char *filePath)
             return &animationFileList[a];
     }
     return NULL;
+#endif
 }
 
 void ProcessObjectAnimation(void *objScr, void *ent)
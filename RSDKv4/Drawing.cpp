@@ -1,5 +1,11 @@
 #include "RetroEngine.hpp"
 
+#if !RETRO_USE_ORIGINAL_CODE
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
 ushort blendLookupTable[0x20 * 0x100];
 ushort subtractLookupTable[0x20 * 0x100];
 ushort tintLookupTable[0x10000];
@@ -30,7 +36,14 @@ DrawListEntry drawListEntries[DRAWLAYER_COUNT];
 
 int gfxDataPosition = 0;
 GFXSurface gfxSurface[SURFACE_COUNT];
+#if RETRO_USE_ORIGINAL_CODE
 byte graphicData[GFXDATA_SIZE];
+#else
+byte *graphicData    = NULL;
+int gfxDataCapacity  = 0;
+int gfxDataHighWater = 0;
+int firstFreeSurface = 0;
+#endif
 
 DisplaySettings displaySettings;
 bool convertTo32Bit     = false;
@@ -264,12 +277,20 @@ int InitRenderDevice()
     Engine.frameBuffer2x = new ushort[GFX_LINESIZE_DOUBLE * (SCREEN_YSIZE * 2)];
     memset(Engine.frameBuffer, 0, (GFX_LINESIZE * SCREEN_YSIZE) * sizeof(ushort));
     memset(Engine.frameBuffer2x, 0, GFX_LINESIZE_DOUBLE * (SCREEN_YSIZE * 2) * sizeof(ushort));
+#if !RETRO_USE_ORIGINAL_CODE
+    InitRenderThreads(Engine.renderThreads);
+#endif
 #endif
     Engine.texBuffer = new uint[GFX_LINESIZE * SCREEN_YSIZE];
     memset(Engine.texBuffer, 0, (GFX_LINESIZE * SCREEN_YSIZE) * sizeof(uint));
 
 #endif
 
+#if !RETRO_USE_ORIGINAL_CODE
+    // scripts can still draw from sheets that failed to load, so there's always some zeroed data behind dataPosition 0
+    ReserveGraphicData(GFXDATA_GRANULARITY);
+#endif
+
     if (Engine.startFullScreen) {
         SetFullScreen(true);
     }
@@ -569,7 +590,15 @@ void ReleaseRenderDevice(bool refresh)
 		CURRENT_DISP_SCREEN = SDL_GetWindowDisplayIndex(Engine.window);
 
 #if !RETRO_USE_ORIGINAL_CODE
+    if (!refresh) {
+        ReleaseSheetCache();
+        ReleaseGraphicData();
+    }
+
 #if RETRO_SOFTWARE_RENDER
+    ReleaseRenderThreads();
+    ReleaseTileCache();
+    ReleaseLayerOcclusion();
     if (Engine.frameBuffer)
         delete[] Engine.frameBuffer;
     if (Engine.frameBuffer2x)
@@ -615,9 +644,884 @@ void GenerateBlendLookupTable(void)
     }
 }
 
+#if !RETRO_USE_ORIGINAL_CODE
+// Span kernels for the blended fills & sprites
+// the scalar versions are the original per-pixel loops, the SIMD versions do the same 5/6/5 channel maths in 16-bit lanes
+// (every product fits: a 6-bit channel * 0x100 is at most 0x3F00) so the output is bit-identical for every alpha
+static void AlphaFillSpan_Scalar(ushort *frameBufferPtr, int count, ushort colour, int alpha)
+{
+    ushort *fbufferBlend = &blendLookupTable[0x20 * (0xFF - alpha)];
+    ushort *pixelBlend   = &blendLookupTable[0x20 * alpha];
+
+    while (count--) {
+        int R = (fbufferBlend[(*frameBufferPtr & 0xF800) >> 11] + pixelBlend[(colour & 0xF800) >> 11]) << 11;
+        int G = (fbufferBlend[(*frameBufferPtr & 0x7E0) >> 6] + pixelBlend[(colour & 0x7E0) >> 6]) << 6;
+        int B = fbufferBlend[*frameBufferPtr & 0x1F] + pixelBlend[colour & 0x1F];
+
+        *frameBufferPtr = R | G | B;
+        ++frameBufferPtr;
+    }
+}
+
+static void TintSpan_Scalar(ushort *frameBufferPtr, int count)
+{
+    while (count--) {
+        *frameBufferPtr = tintLookupTable[*frameBufferPtr];
+        ++frameBufferPtr;
+    }
+}
+
+// the sprite blends are calculated live rather than through the lookup tables (6-bit green, 0x100 - alpha weighting)
+static void AlphaSpriteSpan_Scalar(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count, int alpha)
+{
+    while (count--) {
+        if (*gfxData > 0) {
+            ushort color = palette[*gfxData];
+
+            int R = ((((*frameBufferPtr & 0xF800) >> 11) * (0x100 - alpha)) + (((color & 0xF800) >> 11) * alpha) >> 8) << 11;
+            int G = ((((*frameBufferPtr & 0x7E0) >> 5) * (0x100 - alpha)) + (((color & 0x7E0) >> 5) * alpha) >> 8) << 5;
+            int B = (((*frameBufferPtr & 0x1F) * (0x100 - alpha)) + ((color & 0x1F) * alpha) >> 8);
+
+            *frameBufferPtr = R | G | B;
+        }
+        ++gfxData;
+        ++frameBufferPtr;
+    }
+}
+
+static void AdditiveSpriteSpan_Scalar(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count, int alpha)
+{
+    while (count--) {
+        if (*gfxData > 0) {
+            ushort color = palette[*gfxData];
+
+            int R = minVal((((((color & 0xF800) >> 11) * alpha) >> 8) << 11) + (*frameBufferPtr & 0xF800), 0xF800);
+            int G = minVal((((((color & 0x7E0) >> 5) * alpha) >> 8) << 5) + (*frameBufferPtr & 0x7E0), 0x7E0);
+            int B = minVal((((color & 0x1F) * alpha) >> 8) + (*frameBufferPtr & 0x1F), 0x1F);
+
+            *frameBufferPtr = R | G | B;
+        }
+        ++gfxData;
+        ++frameBufferPtr;
+    }
+}
+
+static void SubtractiveSpriteSpan_Scalar(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count, int alpha)
+{
+    while (count--) {
+        if (*gfxData > 0) {
+            ushort color = palette[*gfxData];
+
+            int R = maxVal((*frameBufferPtr & 0xF800) - (((((0xF800 - (color & 0xF800)) >> 11) * alpha) >> 8) << 11), 0);
+            int G = maxVal((*frameBufferPtr & 0x7E0) - (((((0x7E0 - (color & 0x7E0)) >> 5) * alpha) >> 8) << 5), 0);
+            int B = maxVal((*frameBufferPtr & 0x1F) - (((0x1F - (color & 0x1F)) * alpha) >> 8), 0);
+
+            *frameBufferPtr = R | G | B;
+        }
+        ++gfxData;
+        ++frameBufferPtr;
+    }
+}
+
+// plain keyed copies through the palette, and the 50/50 blend textured faces use
+static void PaletteSpriteSpan_Scalar(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count)
+{
+    while (count--) {
+        if (*gfxData > 0)
+            *frameBufferPtr = palette[*gfxData];
+        ++gfxData;
+        ++frameBufferPtr;
+    }
+}
+
+static void HalfBlendSpriteSpan_Scalar(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count)
+{
+    while (count--) {
+        if (*gfxData > 0)
+            *frameBufferPtr = ((palette[*gfxData] & 0xF7BC) >> 1) + ((*frameBufferPtr & 0xF7BC) >> 1);
+        ++gfxData;
+        ++frameBufferPtr;
+    }
+}
+
+static void FillSpan_Scalar(ushort *frameBufferPtr, int count, ushort colour)
+{
+    while (count--) {
+        *frameBufferPtr = colour;
+        ++frameBufferPtr;
+    }
+}
+
+// magenta pixels are see-through, everything else is doubled into both rows of the 2x buffer
+static void KeyedOverlay2xSpan_Scalar(ushort *frameBuffer2x, int pitch, const ushort *frameBufferPtr, int count)
+{
+    ushort *nextLine = frameBuffer2x + pitch;
+    while (count--) {
+        if (*frameBufferPtr != 0xF81F) {
+            frameBuffer2x[0] = *frameBufferPtr;
+            frameBuffer2x[1] = *frameBufferPtr;
+            nextLine[0]      = *frameBufferPtr;
+            nextLine[1]      = *frameBufferPtr;
+        }
+        frameBuffer2x += 2;
+        nextLine += 2;
+        ++frameBufferPtr;
+    }
+}
+
+#if RETRO_USING_SSE2
+// palette lookups can't be vectorised, so gather them first and only do the blend itself in lanes
+#define GatherSpriteColours(gfxData, palette)                                                                                                        \
+    _mm_setr_epi16(palette[gfxData[0]], palette[gfxData[1]], palette[gfxData[2]], palette[gfxData[3]], palette[gfxData[4]], palette[gfxData[5]],    \
+                   palette[gfxData[6]], palette[gfxData[7]])
+#define GatherSpriteMask(gfxData) _mm_cmpeq_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)gfxData), _mm_setzero_si128()), _mm_setzero_si128())
+
+static void AlphaFillSpan_SSE2(ushort *frameBufferPtr, int count, ushort colour, int alpha)
+{
+    ushort *pixelBlend = &blendLookupTable[0x20 * alpha];
+    __m128i fbAlpha    = _mm_set1_epi16(0xFF - alpha);
+    __m128i clrR       = _mm_set1_epi16(pixelBlend[(colour & 0xF800) >> 11]);
+    __m128i clrG       = _mm_set1_epi16(pixelBlend[(colour & 0x7E0) >> 6]);
+    __m128i clrB       = _mm_set1_epi16(pixelBlend[colour & 0x1F]);
+    __m128i mask5      = _mm_set1_epi16(0x1F);
+
+    for (; count >= 8; count -= 8, frameBufferPtr += 8) {
+        __m128i dst = _mm_loadu_si128((__m128i *)frameBufferPtr);
+        __m128i R   = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(_mm_srli_epi16(dst, 11), fbAlpha), 8), clrR);
+        __m128i G   = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(dst, 6), mask5), fbAlpha), 8), clrG);
+        __m128i B   = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(dst, mask5), fbAlpha), 8), clrB);
+        _mm_storeu_si128((__m128i *)frameBufferPtr, _mm_or_si128(_mm_or_si128(_mm_slli_epi16(R, 11), _mm_slli_epi16(G, 6)), B));
+    }
+    AlphaFillSpan_Scalar(frameBufferPtr, count, colour, alpha);
+}
+
+static void TintSpan_SSE2(ushort *frameBufferPtr, int count)
+{
+    __m128i mask5 = _mm_set1_epi16(0x1F);
+    for (; count >= 8; count -= 8, frameBufferPtr += 8) {
+        __m128i dst  = _mm_loadu_si128((__m128i *)frameBufferPtr);
+        __m128i tint = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(dst, mask5), _mm_and_si128(_mm_srli_epi16(dst, 6), mask5)), _mm_srli_epi16(dst, 11));
+        // x / 3 == (x * 171) >> 9 for every x the sum can reach (0-93)
+        tint = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(tint, _mm_set1_epi16(171)), 9), _mm_set1_epi16(6));
+        tint = _mm_min_epi16(tint, mask5);
+        _mm_storeu_si128((__m128i *)frameBufferPtr, _mm_mullo_epi16(tint, _mm_set1_epi16(0x841)));
+    }
+    TintSpan_Scalar(frameBufferPtr, count);
+}
+
+static void AlphaSpriteSpan_SSE2(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count, int alpha)
+{
+    __m128i fbAlpha  = _mm_set1_epi16(0x100 - alpha);
+    __m128i clrAlpha = _mm_set1_epi16(alpha);
+    __m128i mask5    = _mm_set1_epi16(0x1F);
+    __m128i mask6    = _mm_set1_epi16(0x3F);
+
+    for (; count >= 8; count -= 8, frameBufferPtr += 8, gfxData += 8) {
+        __m128i skip = GatherSpriteMask(gfxData);
+        if (_mm_movemask_epi8(skip) == 0xFFFF)
+            continue;
+        __m128i clr = GatherSpriteColours(gfxData, palette);
+        __m128i dst = _mm_loadu_si128((__m128i *)frameBufferPtr);
+
+        __m128i R = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_srli_epi16(dst, 11), fbAlpha), _mm_mullo_epi16(_mm_srli_epi16(clr, 11), clrAlpha)), 8);
+        __m128i G = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(dst, 5), mask6), fbAlpha),
+                                                 _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(clr, 5), mask6), clrAlpha)),
+                                   8);
+        __m128i B = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(dst, mask5), fbAlpha), _mm_mullo_epi16(_mm_and_si128(clr, mask5), clrAlpha)), 8);
+
+        __m128i blend = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(R, 11), _mm_slli_epi16(G, 5)), B);
+        _mm_storeu_si128((__m128i *)frameBufferPtr, _mm_or_si128(_mm_and_si128(skip, dst), _mm_andnot_si128(skip, blend)));
+    }
+    AlphaSpriteSpan_Scalar(frameBufferPtr, gfxData, palette, count, alpha);
+}
+
+static void AdditiveSpriteSpan_SSE2(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count, int alpha)
+{
+    __m128i clrAlpha = _mm_set1_epi16(alpha);
+    __m128i mask5    = _mm_set1_epi16(0x1F);
+    __m128i mask6    = _mm_set1_epi16(0x3F);
+
+    for (; count >= 8; count -= 8, frameBufferPtr += 8, gfxData += 8) {
+        __m128i skip = GatherSpriteMask(gfxData);
+        if (_mm_movemask_epi8(skip) == 0xFFFF)
+            continue;
+        __m128i clr = GatherSpriteColours(gfxData, palette);
+        __m128i dst = _mm_loadu_si128((__m128i *)frameBufferPtr);
+
+        __m128i R = _mm_min_epi16(_mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(_mm_srli_epi16(clr, 11), clrAlpha), 8), _mm_srli_epi16(dst, 11)), mask5);
+        __m128i G = _mm_min_epi16(_mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(clr, 5), mask6), clrAlpha), 8),
+                                                _mm_and_si128(_mm_srli_epi16(dst, 5), mask6)),
+                                  mask6);
+        __m128i B = _mm_min_epi16(_mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(clr, mask5), clrAlpha), 8), _mm_and_si128(dst, mask5)), mask5);
+
+        __m128i blend = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(R, 11), _mm_slli_epi16(G, 5)), B);
+        _mm_storeu_si128((__m128i *)frameBufferPtr, _mm_or_si128(_mm_and_si128(skip, dst), _mm_andnot_si128(skip, blend)));
+    }
+    AdditiveSpriteSpan_Scalar(frameBufferPtr, gfxData, palette, count, alpha);
+}
+
+static void SubtractiveSpriteSpan_SSE2(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count, int alpha)
+{
+    __m128i clrAlpha = _mm_set1_epi16(alpha);
+    __m128i mask5    = _mm_set1_epi16(0x1F);
+    __m128i mask6    = _mm_set1_epi16(0x3F);
+
+    for (; count >= 8; count -= 8, frameBufferPtr += 8, gfxData += 8) {
+        __m128i skip = GatherSpriteMask(gfxData);
+        if (_mm_movemask_epi8(skip) == 0xFFFF)
+            continue;
+        __m128i clr = GatherSpriteColours(gfxData, palette);
+        __m128i dst = _mm_loadu_si128((__m128i *)frameBufferPtr);
+
+        __m128i R = _mm_subs_epu16(_mm_srli_epi16(dst, 11), _mm_srli_epi16(_mm_mullo_epi16(_mm_sub_epi16(mask5, _mm_srli_epi16(clr, 11)), clrAlpha), 8));
+        __m128i G = _mm_subs_epu16(_mm_and_si128(_mm_srli_epi16(dst, 5), mask6),
+                                   _mm_srli_epi16(_mm_mullo_epi16(_mm_sub_epi16(mask6, _mm_and_si128(_mm_srli_epi16(clr, 5), mask6)), clrAlpha), 8));
+        __m128i B = _mm_subs_epu16(_mm_and_si128(dst, mask5), _mm_srli_epi16(_mm_mullo_epi16(_mm_sub_epi16(mask5, _mm_and_si128(clr, mask5)), clrAlpha), 8));
+
+        __m128i blend = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(R, 11), _mm_slli_epi16(G, 5)), B);
+        _mm_storeu_si128((__m128i *)frameBufferPtr, _mm_or_si128(_mm_and_si128(skip, dst), _mm_andnot_si128(skip, blend)));
+    }
+    SubtractiveSpriteSpan_Scalar(frameBufferPtr, gfxData, palette, count, alpha);
+}
+
+static void PaletteSpriteSpan_SSE2(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count)
+{
+    for (; count >= 8; count -= 8, frameBufferPtr += 8, gfxData += 8) {
+        __m128i skip = GatherSpriteMask(gfxData);
+        int skipMask = _mm_movemask_epi8(skip);
+        if (skipMask == 0xFFFF)
+            continue;
+        __m128i clr = GatherSpriteColours(gfxData, palette);
+        if (skipMask) {
+            __m128i dst = _mm_loadu_si128((__m128i *)frameBufferPtr);
+            clr         = _mm_or_si128(_mm_and_si128(skip, dst), _mm_andnot_si128(skip, clr));
+        }
+        _mm_storeu_si128((__m128i *)frameBufferPtr, clr);
+    }
+    PaletteSpriteSpan_Scalar(frameBufferPtr, gfxData, palette, count);
+}
+
+static void HalfBlendSpriteSpan_SSE2(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count)
+{
+    __m128i mask = _mm_set1_epi16((short)0xF7BC);
+    for (; count >= 8; count -= 8, frameBufferPtr += 8, gfxData += 8) {
+        __m128i skip = GatherSpriteMask(gfxData);
+        if (_mm_movemask_epi8(skip) == 0xFFFF)
+            continue;
+        __m128i clr = GatherSpriteColours(gfxData, palette);
+        __m128i dst = _mm_loadu_si128((__m128i *)frameBufferPtr);
+
+        __m128i blend = _mm_add_epi16(_mm_srli_epi16(_mm_and_si128(clr, mask), 1), _mm_srli_epi16(_mm_and_si128(dst, mask), 1));
+        _mm_storeu_si128((__m128i *)frameBufferPtr, _mm_or_si128(_mm_and_si128(skip, dst), _mm_andnot_si128(skip, blend)));
+    }
+    HalfBlendSpriteSpan_Scalar(frameBufferPtr, gfxData, palette, count);
+}
+
+static void FillSpan_SSE2(ushort *frameBufferPtr, int count, ushort colour)
+{
+    __m128i clr = _mm_set1_epi16(colour);
+    for (; count >= 32; count -= 32, frameBufferPtr += 32) {
+        _mm_storeu_si128((__m128i *)frameBufferPtr, clr);
+        _mm_storeu_si128((__m128i *)(frameBufferPtr + 8), clr);
+        _mm_storeu_si128((__m128i *)(frameBufferPtr + 16), clr);
+        _mm_storeu_si128((__m128i *)(frameBufferPtr + 24), clr);
+    }
+    for (; count >= 8; count -= 8, frameBufferPtr += 8) _mm_storeu_si128((__m128i *)frameBufferPtr, clr);
+    FillSpan_Scalar(frameBufferPtr, count, colour);
+}
+
+// each source lane is unpacked with itself for the horizontal doubling and the same result is stored to both rows,
+// with the magenta lanes keeping whatever each row already had
+static void KeyedOverlay2xSpan_SSE2(ushort *frameBuffer2x, int pitch, const ushort *frameBufferPtr, int count)
+{
+    __m128i key      = _mm_set1_epi16((short)0xF81F);
+    ushort *nextLine = frameBuffer2x + pitch;
+
+    for (; count >= 8; count -= 8, frameBufferPtr += 8, frameBuffer2x += 16, nextLine += 16) {
+        __m128i src  = _mm_loadu_si128((const __m128i *)frameBufferPtr);
+        __m128i keep = _mm_cmpeq_epi16(src, key);
+        int keepMask = _mm_movemask_epi8(keep);
+        if (keepMask == 0xFFFF)
+            continue;
+
+        __m128i lo = _mm_unpacklo_epi16(src, src);
+        __m128i hi = _mm_unpackhi_epi16(src, src);
+        if (keepMask) {
+            __m128i keepLo = _mm_unpacklo_epi16(keep, keep);
+            __m128i keepHi = _mm_unpackhi_epi16(keep, keep);
+            __m128i dstLo  = _mm_loadu_si128((__m128i *)frameBuffer2x);
+            __m128i dstHi  = _mm_loadu_si128((__m128i *)(frameBuffer2x + 8));
+            __m128i nextLo = _mm_loadu_si128((__m128i *)nextLine);
+            __m128i nextHi = _mm_loadu_si128((__m128i *)(nextLine + 8));
+            _mm_storeu_si128((__m128i *)frameBuffer2x, _mm_or_si128(_mm_and_si128(keepLo, dstLo), _mm_andnot_si128(keepLo, lo)));
+            _mm_storeu_si128((__m128i *)(frameBuffer2x + 8), _mm_or_si128(_mm_and_si128(keepHi, dstHi), _mm_andnot_si128(keepHi, hi)));
+            _mm_storeu_si128((__m128i *)nextLine, _mm_or_si128(_mm_and_si128(keepLo, nextLo), _mm_andnot_si128(keepLo, lo)));
+            _mm_storeu_si128((__m128i *)(nextLine + 8), _mm_or_si128(_mm_and_si128(keepHi, nextHi), _mm_andnot_si128(keepHi, hi)));
+        }
+        else {
+            _mm_storeu_si128((__m128i *)frameBuffer2x, lo);
+            _mm_storeu_si128((__m128i *)(frameBuffer2x + 8), hi);
+            _mm_storeu_si128((__m128i *)nextLine, lo);
+            _mm_storeu_si128((__m128i *)(nextLine + 8), hi);
+        }
+    }
+    KeyedOverlay2xSpan_Scalar(frameBuffer2x, pitch, frameBufferPtr, count);
+}
+#elif RETRO_USING_NEON
+static inline uint16x8_t GatherSpriteColours(const byte *gfxData, const ushort *palette)
+{
+    ushort colours[8];
+    for (int i = 0; i < 8; ++i) colours[i] = palette[gfxData[i]];
+    return vld1q_u16(colours);
+}
+#define GatherSpriteMask(gfxData) vceqq_u16(vmovl_u8(vld1_u8(gfxData)), vdupq_n_u16(0))
+#define SpriteMaskIsEmpty(skip)   (vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(skip)), 0) == 0xFFFFFFFFFFFFFFFFULL)
+
+static void AlphaFillSpan_NEON(ushort *frameBufferPtr, int count, ushort colour, int alpha)
+{
+    ushort *pixelBlend = &blendLookupTable[0x20 * alpha];
+    uint16x8_t fbAlpha = vdupq_n_u16(0xFF - alpha);
+    uint16x8_t clrR    = vdupq_n_u16(pixelBlend[(colour & 0xF800) >> 11]);
+    uint16x8_t clrG    = vdupq_n_u16(pixelBlend[(colour & 0x7E0) >> 6]);
+    uint16x8_t clrB    = vdupq_n_u16(pixelBlend[colour & 0x1F]);
+    uint16x8_t mask5   = vdupq_n_u16(0x1F);
+
+    for (; count >= 8; count -= 8, frameBufferPtr += 8) {
+        uint16x8_t dst = vld1q_u16(frameBufferPtr);
+        uint16x8_t R   = vaddq_u16(vshrq_n_u16(vmulq_u16(vshrq_n_u16(dst, 11), fbAlpha), 8), clrR);
+        uint16x8_t G   = vaddq_u16(vshrq_n_u16(vmulq_u16(vandq_u16(vshrq_n_u16(dst, 6), mask5), fbAlpha), 8), clrG);
+        uint16x8_t B   = vaddq_u16(vshrq_n_u16(vmulq_u16(vandq_u16(dst, mask5), fbAlpha), 8), clrB);
+        vst1q_u16(frameBufferPtr, vorrq_u16(vorrq_u16(vshlq_n_u16(R, 11), vshlq_n_u16(G, 6)), B));
+    }
+    AlphaFillSpan_Scalar(frameBufferPtr, count, colour, alpha);
+}
+
+static void TintSpan_NEON(ushort *frameBufferPtr, int count)
+{
+    uint16x8_t mask5 = vdupq_n_u16(0x1F);
+    for (; count >= 8; count -= 8, frameBufferPtr += 8) {
+        uint16x8_t dst  = vld1q_u16(frameBufferPtr);
+        uint16x8_t tint = vaddq_u16(vaddq_u16(vandq_u16(dst, mask5), vandq_u16(vshrq_n_u16(dst, 6), mask5)), vshrq_n_u16(dst, 11));
+        tint            = vminq_u16(vaddq_u16(vshrq_n_u16(vmulq_n_u16(tint, 171), 9), vdupq_n_u16(6)), mask5);
+        vst1q_u16(frameBufferPtr, vmulq_n_u16(tint, 0x841));
+    }
+    TintSpan_Scalar(frameBufferPtr, count);
+}
+
+static void AlphaSpriteSpan_NEON(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count, int alpha)
+{
+    uint16x8_t mask5 = vdupq_n_u16(0x1F);
+    uint16x8_t mask6 = vdupq_n_u16(0x3F);
+
+    for (; count >= 8; count -= 8, frameBufferPtr += 8, gfxData += 8) {
+        uint16x8_t skip = GatherSpriteMask(gfxData);
+        if (SpriteMaskIsEmpty(skip))
+            continue;
+        uint16x8_t clr = GatherSpriteColours(gfxData, palette);
+        uint16x8_t dst = vld1q_u16(frameBufferPtr);
+
+        uint16x8_t R = vshrq_n_u16(vmlaq_n_u16(vmulq_n_u16(vshrq_n_u16(dst, 11), 0x100 - alpha), vshrq_n_u16(clr, 11), alpha), 8);
+        uint16x8_t G =
+            vshrq_n_u16(vmlaq_n_u16(vmulq_n_u16(vandq_u16(vshrq_n_u16(dst, 5), mask6), 0x100 - alpha), vandq_u16(vshrq_n_u16(clr, 5), mask6), alpha), 8);
+        uint16x8_t B = vshrq_n_u16(vmlaq_n_u16(vmulq_n_u16(vandq_u16(dst, mask5), 0x100 - alpha), vandq_u16(clr, mask5), alpha), 8);
+
+        uint16x8_t blend = vorrq_u16(vorrq_u16(vshlq_n_u16(R, 11), vshlq_n_u16(G, 5)), B);
+        vst1q_u16(frameBufferPtr, vbslq_u16(skip, dst, blend));
+    }
+    AlphaSpriteSpan_Scalar(frameBufferPtr, gfxData, palette, count, alpha);
+}
+
+static void AdditiveSpriteSpan_NEON(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count, int alpha)
+{
+    uint16x8_t mask5 = vdupq_n_u16(0x1F);
+    uint16x8_t mask6 = vdupq_n_u16(0x3F);
+
+    for (; count >= 8; count -= 8, frameBufferPtr += 8, gfxData += 8) {
+        uint16x8_t skip = GatherSpriteMask(gfxData);
+        if (SpriteMaskIsEmpty(skip))
+            continue;
+        uint16x8_t clr = GatherSpriteColours(gfxData, palette);
+        uint16x8_t dst = vld1q_u16(frameBufferPtr);
+
+        uint16x8_t R = vminq_u16(vaddq_u16(vshrq_n_u16(vmulq_n_u16(vshrq_n_u16(clr, 11), alpha), 8), vshrq_n_u16(dst, 11)), mask5);
+        uint16x8_t G = vminq_u16(vaddq_u16(vshrq_n_u16(vmulq_n_u16(vandq_u16(vshrq_n_u16(clr, 5), mask6), alpha), 8), vandq_u16(vshrq_n_u16(dst, 5), mask6)), mask6);
+        uint16x8_t B = vminq_u16(vaddq_u16(vshrq_n_u16(vmulq_n_u16(vandq_u16(clr, mask5), alpha), 8), vandq_u16(dst, mask5)), mask5);
+
+        uint16x8_t blend = vorrq_u16(vorrq_u16(vshlq_n_u16(R, 11), vshlq_n_u16(G, 5)), B);
+        vst1q_u16(frameBufferPtr, vbslq_u16(skip, dst, blend));
+    }
+    AdditiveSpriteSpan_Scalar(frameBufferPtr, gfxData, palette, count, alpha);
+}
+
+static void SubtractiveSpriteSpan_NEON(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count, int alpha)
+{
+    uint16x8_t mask5 = vdupq_n_u16(0x1F);
+    uint16x8_t mask6 = vdupq_n_u16(0x3F);
+
+    for (; count >= 8; count -= 8, frameBufferPtr += 8, gfxData += 8) {
+        uint16x8_t skip = GatherSpriteMask(gfxData);
+        if (SpriteMaskIsEmpty(skip))
+            continue;
+        uint16x8_t clr = GatherSpriteColours(gfxData, palette);
+        uint16x8_t dst = vld1q_u16(frameBufferPtr);
+
+        uint16x8_t R = vqsubq_u16(vshrq_n_u16(dst, 11), vshrq_n_u16(vmulq_n_u16(vsubq_u16(mask5, vshrq_n_u16(clr, 11)), alpha), 8));
+        uint16x8_t G = vqsubq_u16(vandq_u16(vshrq_n_u16(dst, 5), mask6), vshrq_n_u16(vmulq_n_u16(vsubq_u16(mask6, vandq_u16(vshrq_n_u16(clr, 5), mask6)), alpha), 8));
+        uint16x8_t B = vqsubq_u16(vandq_u16(dst, mask5), vshrq_n_u16(vmulq_n_u16(vsubq_u16(mask5, vandq_u16(clr, mask5)), alpha), 8));
+
+        uint16x8_t blend = vorrq_u16(vorrq_u16(vshlq_n_u16(R, 11), vshlq_n_u16(G, 5)), B);
+        vst1q_u16(frameBufferPtr, vbslq_u16(skip, dst, blend));
+    }
+    SubtractiveSpriteSpan_Scalar(frameBufferPtr, gfxData, palette, count, alpha);
+}
+
+static void PaletteSpriteSpan_NEON(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count)
+{
+    for (; count >= 8; count -= 8, frameBufferPtr += 8, gfxData += 8) {
+        uint16x8_t skip = GatherSpriteMask(gfxData);
+        if (SpriteMaskIsEmpty(skip))
+            continue;
+        uint16x8_t clr = GatherSpriteColours(gfxData, palette);
+        vst1q_u16(frameBufferPtr, vbslq_u16(skip, vld1q_u16(frameBufferPtr), clr));
+    }
+    PaletteSpriteSpan_Scalar(frameBufferPtr, gfxData, palette, count);
+}
+
+static void HalfBlendSpriteSpan_NEON(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count)
+{
+    uint16x8_t mask = vdupq_n_u16(0xF7BC);
+    for (; count >= 8; count -= 8, frameBufferPtr += 8, gfxData += 8) {
+        uint16x8_t skip = GatherSpriteMask(gfxData);
+        if (SpriteMaskIsEmpty(skip))
+            continue;
+        uint16x8_t clr = GatherSpriteColours(gfxData, palette);
+        uint16x8_t dst = vld1q_u16(frameBufferPtr);
+
+        uint16x8_t blend = vaddq_u16(vshrq_n_u16(vandq_u16(clr, mask), 1), vshrq_n_u16(vandq_u16(dst, mask), 1));
+        vst1q_u16(frameBufferPtr, vbslq_u16(skip, dst, blend));
+    }
+    HalfBlendSpriteSpan_Scalar(frameBufferPtr, gfxData, palette, count);
+}
+
+static void FillSpan_NEON(ushort *frameBufferPtr, int count, ushort colour)
+{
+    uint16x8_t clr = vdupq_n_u16(colour);
+    for (; count >= 32; count -= 32, frameBufferPtr += 32) {
+        vst1q_u16(frameBufferPtr, clr);
+        vst1q_u16(frameBufferPtr + 8, clr);
+        vst1q_u16(frameBufferPtr + 16, clr);
+        vst1q_u16(frameBufferPtr + 24, clr);
+    }
+    for (; count >= 8; count -= 8, frameBufferPtr += 8) vst1q_u16(frameBufferPtr, clr);
+    FillSpan_Scalar(frameBufferPtr, count, colour);
+}
+
+// vst2 interleaves the source with itself for the horizontal doubling, masked lanes are zipped the same way
+static void KeyedOverlay2xSpan_NEON(ushort *frameBuffer2x, int pitch, const ushort *frameBufferPtr, int count)
+{
+    uint16x8_t key   = vdupq_n_u16(0xF81F);
+    ushort *nextLine = frameBuffer2x + pitch;
+
+    for (; count >= 8; count -= 8, frameBufferPtr += 8, frameBuffer2x += 16, nextLine += 16) {
+        uint16x8_t src  = vld1q_u16(frameBufferPtr);
+        uint16x8_t keep = vceqq_u16(src, key);
+        if (SpriteMaskIsEmpty(keep))
+            continue;
+
+        if (vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(keep)), 0)) {
+            uint16x8x2_t keep2x = vzipq_u16(keep, keep);
+            uint16x8x2_t pixels = vzipq_u16(src, src);
+            vst1q_u16(frameBuffer2x, vbslq_u16(keep2x.val[0], vld1q_u16(frameBuffer2x), pixels.val[0]));
+            vst1q_u16(frameBuffer2x + 8, vbslq_u16(keep2x.val[1], vld1q_u16(frameBuffer2x + 8), pixels.val[1]));
+            vst1q_u16(nextLine, vbslq_u16(keep2x.val[0], vld1q_u16(nextLine), pixels.val[0]));
+            vst1q_u16(nextLine + 8, vbslq_u16(keep2x.val[1], vld1q_u16(nextLine + 8), pixels.val[1]));
+        }
+        else {
+            uint16x8x2_t doubled = { { src, src } };
+            vst2q_u16(frameBuffer2x, doubled);
+            vst2q_u16(nextLine, doubled);
+        }
+    }
+    KeyedOverlay2xSpan_Scalar(frameBuffer2x, pitch, frameBufferPtr, count);
+}
+#endif
+
+BlendKernels blendKernels = { AlphaFillSpan_Scalar,         TintSpan_Scalar, AlphaSpriteSpan_Scalar,   AdditiveSpriteSpan_Scalar,
+                               SubtractiveSpriteSpan_Scalar, FillSpan_Scalar, KeyedOverlay2xSpan_Scalar, PaletteSpriteSpan_Scalar,
+                               HalfBlendSpriteSpan_Scalar };
+
+void SetBlendKernels(bool useSIMD)
+{
+    blendKernels.alphaFill         = AlphaFillSpan_Scalar;
+    blendKernels.tint              = TintSpan_Scalar;
+    blendKernels.alphaSprite       = AlphaSpriteSpan_Scalar;
+    blendKernels.additiveSprite    = AdditiveSpriteSpan_Scalar;
+    blendKernels.subtractiveSprite = SubtractiveSpriteSpan_Scalar;
+    blendKernels.fill              = FillSpan_Scalar;
+    blendKernels.keyedOverlay2x    = KeyedOverlay2xSpan_Scalar;
+    blendKernels.paletteSprite     = PaletteSpriteSpan_Scalar;
+    blendKernels.halfBlendSprite   = HalfBlendSpriteSpan_Scalar;
+
+    if (useSIMD) {
+#if RETRO_USING_SSE2
+        blendKernels.alphaFill         = AlphaFillSpan_SSE2;
+        blendKernels.tint              = TintSpan_SSE2;
+        blendKernels.alphaSprite       = AlphaSpriteSpan_SSE2;
+        blendKernels.additiveSprite    = AdditiveSpriteSpan_SSE2;
+        blendKernels.subtractiveSprite = SubtractiveSpriteSpan_SSE2;
+        blendKernels.fill              = FillSpan_SSE2;
+        blendKernels.keyedOverlay2x    = KeyedOverlay2xSpan_SSE2;
+        blendKernels.paletteSprite     = PaletteSpriteSpan_SSE2;
+        blendKernels.halfBlendSprite   = HalfBlendSpriteSpan_SSE2;
+#elif RETRO_USING_NEON
+        blendKernels.alphaFill         = AlphaFillSpan_NEON;
+        blendKernels.tint              = TintSpan_NEON;
+        blendKernels.alphaSprite       = AlphaSpriteSpan_NEON;
+        blendKernels.additiveSprite    = AdditiveSpriteSpan_NEON;
+        blendKernels.subtractiveSprite = SubtractiveSpriteSpan_NEON;
+        blendKernels.fill              = FillSpan_NEON;
+        blendKernels.keyedOverlay2x    = KeyedOverlay2xSpan_NEON;
+        blendKernels.paletteSprite     = PaletteSpriteSpan_NEON;
+        blendKernels.halfBlendSprite   = HalfBlendSpriteSpan_NEON;
+#endif
+    }
+}
+
+void BenchmarkBlendKernels()
+{
+#if RETRO_SOFTWARE_RENDER
+    // full screen fades & water are the worst case for blending, so time a full screen rect at every alpha level with both kernel sets,
+    // checking the results match while we're at it
+    const int passCount  = 16;
+    const int pixelCount = GFX_LINESIZE * SCREEN_YSIZE;
+    ushort *reference    = new ushort[pixelCount];
+
+    double freq         = (double)SDL_GetPerformanceFrequency() / 1000.0;
+    double totalTime[2] = { 0.0, 0.0 };
+    int mismatches      = 0;
+    for (int a = 0; a <= 0xFF; ++a) {
+        double time[2] = { 0.0, 0.0 };
+        for (int k = 0; k < 2; ++k) {
+            SetBlendKernels(k == 1);
+            for (int i = 0; i < pixelCount; ++i) Engine.frameBuffer[i] = (ushort)(i * 0x9E37);
+
+            DrawRectangle(0, 0, GFX_LINESIZE, SCREEN_YSIZE, 0x40, 0x80, 0xC0, a);
+            if (!k)
+                memcpy(reference, Engine.frameBuffer, pixelCount * sizeof(ushort));
+            else if (memcmp(reference, Engine.frameBuffer, pixelCount * sizeof(ushort)))
+                mismatches++;
+
+            unsigned long long start = SDL_GetPerformanceCounter();
+            for (int p = 0; p < passCount; ++p) DrawRectangle(0, 0, GFX_LINESIZE, SCREEN_YSIZE, 0x40, 0x80, 0xC0, a);
+            time[k] = (SDL_GetPerformanceCounter() - start) / freq / passCount;
+            totalTime[k] += time[k];
+        }
+        PrintLog("Blend benchmark: alpha %3d, scalar %.4fms, SIMD %.4fms", a, time[0], time[1]);
+    }
+    PrintLog("Blend benchmark: avg scalar %.4fms, avg SIMD %.4fms (%.2fx), %d mismatched alpha levels", totalTime[0] / 0x100, totalTime[1] / 0x100,
+             totalTime[1] > 0.0 ? totalTime[0] / totalTime[1] : 0.0, mismatches);
+
+    delete[] reference;
+    memset(Engine.frameBuffer, 0, pixelCount * sizeof(ushort));
+    SetBlendKernels(Engine.useSIMD);
+#endif
+}
+
+void BenchmarkFrameKernels()
+{
+#if RETRO_SOFTWARE_RENDER
+    // ClearScreen & the HQ overlay copy touch every pixel every frame, so time both with each kernel set and check they match
+    const int passCount    = 64;
+    const int pixelCount   = GFX_LINESIZE * SCREEN_YSIZE;
+    const int pixelCount2x = GFX_LINESIZE_DOUBLE * SCREEN_YSIZE * 2;
+    ushort *clearReference = new ushort[pixelCount];
+    ushort *copyReference  = new ushort[pixelCount2x];
+
+    double freq         = (double)SDL_GetPerformanceFrequency() / 1000.0;
+    double clearTime[2] = { 0.0, 0.0 };
+    double copyTime[2]  = { 0.0, 0.0 };
+    int mismatches      = 0;
+    for (int k = 0; k < 2; ++k) {
+        SetBlendKernels(k == 1);
+
+        ClearScreen(0x40);
+        if (!k)
+            memcpy(clearReference, Engine.frameBuffer, pixelCount * sizeof(ushort));
+        else if (memcmp(clearReference, Engine.frameBuffer, pixelCount * sizeof(ushort)))
+            mismatches++;
+
+        unsigned long long start = SDL_GetPerformanceCounter();
+        for (int p = 0; p < passCount; ++p) ClearScreen(p & 0xFF);
+        clearTime[k] = (SDL_GetPerformanceCounter() - start) / freq / passCount;
+
+        // the lower half is a mix of see-through runs (where the 3D scene shows), solid runs & single magenta pixels
+        for (int y = 0; y < SCREEN_YSIZE; ++y) {
+            for (int x = 0; x < GFX_LINESIZE; ++x) {
+                bool keyed                               = ((x >> 4) + (y >> 3)) % 3 == 0 || (x * y) % 13 == 0;
+                Engine.frameBuffer[x + y * GFX_LINESIZE] = keyed ? 0xF81F : (ushort)((x + y * GFX_LINESIZE) * 0x9E37);
+            }
+        }
+        for (int i = 0; i < pixelCount2x; ++i) Engine.frameBuffer2x[i] = (ushort)(i * 0x3B9B);
+
+        CopyFrameOverlay2x();
+        if (!k)
+            memcpy(copyReference, Engine.frameBuffer2x, pixelCount2x * sizeof(ushort));
+        else if (memcmp(copyReference, Engine.frameBuffer2x, pixelCount2x * sizeof(ushort)))
+            mismatches++;
+
+        start = SDL_GetPerformanceCounter();
+        for (int p = 0; p < passCount; ++p) CopyFrameOverlay2x();
+        copyTime[k] = (SDL_GetPerformanceCounter() - start) / freq / passCount;
+    }
+    PrintLog("Frame benchmark: ClearScreen scalar %.4fms, SIMD %.4fms (%.2fx)", clearTime[0], clearTime[1],
+             clearTime[1] > 0.0 ? clearTime[0] / clearTime[1] : 0.0);
+    PrintLog("Frame benchmark: CopyFrameOverlay2x scalar %.4fms, SIMD %.4fms (%.2fx)", copyTime[0], copyTime[1],
+             copyTime[1] > 0.0 ? copyTime[0] / copyTime[1] : 0.0);
+    PrintLog("Frame benchmark: %d mismatched results", mismatches);
+
+    delete[] clearReference;
+    delete[] copyReference;
+    memset(Engine.frameBuffer, 0, pixelCount * sizeof(ushort));
+    memset(Engine.frameBuffer2x, 0, pixelCount2x * sizeof(ushort));
+    SetBlendKernels(Engine.useSIMD);
+#endif
+}
+
+#if RETRO_SOFTWARE_RENDER
+// swaps stage layers 1-3, the tileset, the palettes & a free sprite sheet for made up ones: a solid HScroll layer (1), a sparse one to
+// draw over it (2) and a layer for the 3D scenes (3)
+void SetupBenchmarkStage(BenchmarkStage *stage)
+{
+    memcpy(stage->layers, &stageLayouts[1], sizeof(stage->layers));
+    memcpy(&stage->tiles, &tiles128x128, sizeof(Tiles128x128));
+    memcpy(stage->tileset, tilesetGFXData, TILESET_SIZE);
+    memcpy(stage->floorBuffer, tile3DFloorBuffer, sizeof(stage->floorBuffer));
+    memcpy(stage->palette, fullPalette, sizeof(stage->palette));
+    memcpy(stage->palette32, fullPalette32, sizeof(stage->palette32));
+    memcpy(stage->lineBuffer, gfxLineBuffer, sizeof(stage->lineBuffer));
+    memcpy(stage->activeLayers, activeTileLayers, sizeof(stage->activeLayers));
+    stage->activePalette   = activePalette;
+    stage->activePalette32 = activePalette32;
+    stage->hParallax       = hParallax;
+    stage->vParallax       = vParallax;
+    stage->midPoint        = tLayerMidPoint;
+    stage->occlusion       = layerOcclusion.active;
+    stage->stageHQ         = drawStageGFXHQ;
+    stage->xScroll         = xScrollOffset;
+    stage->yScroll         = yScrollOffset;
+    stage->xSize           = lastXSize;
+    stage->ySize           = lastYSize;
+    memcpy(stage->vertices, vertexBuffer, sizeof(stage->vertices));
+    memcpy(stage->faces, faceBuffer, sizeof(stage->faces));
+    stage->vertexCount = vertexCount;
+    stage->faceCount   = faceCount;
+    stage->matWorld    = matWorld;
+    stage->matView     = matView;
+    stage->fogColor    = fogColor;
+    stage->fogStrength = fogStrength;
+
+    for (int t = 0; t < TILE_COUNT; ++t) {
+        for (int i = 0; i < TILE_DATASIZE; ++i) {
+            byte index = 1 + ((uint)(t * TILE_DATASIZE + i) * 0x9E37 >> 4) % 0xFF;
+            switch (t % 3) {
+                case 0: tilesetGFXData[t * TILE_DATASIZE + i] = 0; break;
+                case 1: tilesetGFXData[t * TILE_DATASIZE + i] = index; break;
+                case 2: tilesetGFXData[t * TILE_DATASIZE + i] = i >= TILE_DATASIZE / 2 ? index : 0; break;
+            }
+        }
+        UpdateTileOpacity(t);
+    }
+    for (int i = 0; i < CHUNKTILE_COUNT; ++i) {
+        tiles128x128.gfxDataPos[i]  = (i * 7 % TILE_COUNT) * TILE_DATASIZE;
+        tiles128x128.direction[i]   = i & 3;
+        tiles128x128.visualPlane[i] = 0;
+    }
+    memset(&stageLayouts[1], 0, 3 * sizeof(TileLayer));
+    for (int l = 1; l <= 3; ++l) {
+        TileLayer *layer = &stageLayouts[l];
+        for (int i = 0; i < TILELAYER_CHUNK_COUNT; ++i) layer->tiles[i] = (i * (l == 2 ? 5 : 1)) % (CHUNKTILE_COUNT >> 6);
+        layer->type           = LAYER_HSCROLL;
+        layer->xsize          = 16;
+        layer->ysize          = 16;
+        layer->parallaxFactor = 0x100;
+    }
+    Init3DFloorBuffer(3);
+
+    memset(&hParallax, 0, sizeof(hParallax));
+    memset(&vParallax, 0, sizeof(vParallax));
+    hParallax.entryCount        = 1;
+    hParallax.parallaxFactor[0] = 0x100;
+    vParallax.entryCount        = 1;
+    vParallax.parallaxFactor[0] = 0x100;
+    activeTileLayers[0]         = 1;
+    activeTileLayers[1]         = LAYER_COUNT;
+    activeTileLayers[2]         = LAYER_COUNT;
+    activeTileLayers[3]         = LAYER_COUNT;
+    tLayerMidPoint              = 1;
+    layerOcclusion.active       = false;
+    drawStageGFXHQ              = false;
+
+    for (int p = 0; p < 3; ++p) {
+        for (int c = 0; c < PALETTE_COLOR_COUNT; ++c) {
+            uint rgb = (uint)(c + 1) * (p ? 0x2F9A73 : 0x9E3779);
+            SetPaletteEntry(p, c, rgb >> 16, rgb >> 8, rgb);
+        }
+    }
+    SetActivePalette(0, 0, SCREEN_YSIZE);
+
+    // blocks & columns of transparency with long opaque runs between them, so the sheet gets sprite spans too
+    stage->sheetID = -1;
+    for (int s = 0; s < SURFACE_COUNT; ++s) {
+        if (StrLength(gfxSurface[s].fileName) == 0) {
+            stage->sheetID = s;
+            break;
+        }
+    }
+    if (stage->sheetID >= 0 && ReserveGraphicData(gfxDataPosition + BENCHMARK_SHEET_SIZE * BENCHMARK_SHEET_SIZE)) {
+        GFXSurface *surface = &gfxSurface[stage->sheetID];
+        StrCopy(surface->fileName, "Benchmark");
+        surface->width        = BENCHMARK_SHEET_SIZE;
+        surface->height       = BENCHMARK_SHEET_SIZE;
+        surface->widthShift   = 8;
+        surface->depth        = 1;
+        surface->dataPosition = gfxDataPosition;
+
+        byte *gfxData = &graphicData[gfxDataPosition];
+        for (int y = 0; y < BENCHMARK_SHEET_SIZE; ++y) {
+            for (int x = 0; x < BENCHMARK_SHEET_SIZE; ++x) {
+                int block  = ((x >> 4) + (y >> 4) * 3) % 5;
+                *gfxData++ = block == 0 || block == 3 || (x & 0x1F) >= 0x1C ? 0 : 1 + ((uint)(y * BENCHMARK_SHEET_SIZE + x) * 0x9E37 >> 5) % 0xFF;
+            }
+        }
+        gfxDataPosition += BENCHMARK_SHEET_SIZE * BENCHMARK_SHEET_SIZE;
+    }
+    else {
+        stage->sheetID = -1;
+    }
+}
+
+void RestoreBenchmarkStage(BenchmarkStage *stage)
+{
+    if (stage->sheetID >= 0) {
+        // the sheet was added last, so it can just be dropped off the end
+        ReleaseSurfaceSpans(stage->sheetID);
+        gfxDataPosition -= BENCHMARK_SHEET_SIZE * BENCHMARK_SHEET_SIZE;
+        MEM_ZERO(gfxSurface[stage->sheetID]);
+        if (stage->sheetID < firstFreeSurface)
+            firstFreeSurface = stage->sheetID;
+    }
+
+    memcpy(&stageLayouts[1], stage->layers, sizeof(stage->layers));
+    memcpy(&tiles128x128, &stage->tiles, sizeof(Tiles128x128));
+    memcpy(tilesetGFXData, stage->tileset, TILESET_SIZE);
+    memcpy(tile3DFloorBuffer, stage->floorBuffer, sizeof(stage->floorBuffer));
+    memcpy(fullPalette, stage->palette, sizeof(stage->palette));
+    memcpy(fullPalette32, stage->palette32, sizeof(stage->palette32));
+    memcpy(gfxLineBuffer, stage->lineBuffer, sizeof(stage->lineBuffer));
+    memcpy(activeTileLayers, stage->activeLayers, sizeof(stage->activeLayers));
+    activePalette         = stage->activePalette;
+    activePalette32       = stage->activePalette32;
+    hParallax             = stage->hParallax;
+    vParallax             = stage->vParallax;
+    tLayerMidPoint        = stage->midPoint;
+    layerOcclusion.active = stage->occlusion;
+    drawStageGFXHQ        = stage->stageHQ;
+    xScrollOffset         = stage->xScroll;
+    yScrollOffset         = stage->yScroll;
+    lastXSize             = stage->xSize;
+    lastYSize             = stage->ySize;
+    memcpy(vertexBuffer, stage->vertices, sizeof(stage->vertices));
+    memcpy(faceBuffer, stage->faces, sizeof(stage->faces));
+    vertexCount = stage->vertexCount;
+    faceCount   = stage->faceCount;
+    matWorld    = stage->matWorld;
+    matView     = stage->matView;
+    fogColor    = stage->fogColor;
+    fogStrength = stage->fogStrength;
+    for (int t = 0; t < TILE_COUNT; ++t) UpdateTileOpacity(t);
+    for (int p = 0; p < PALETTE_COUNT; ++p) ++paletteGeneration[p];
+
+    // the tile cache picked up the made up tiles
+    ResetTileCache();
+    memset(Engine.frameBuffer, 0, GFX_LINESIZE * SCREEN_YSIZE * sizeof(ushort));
+    memset(Engine.frameBuffer2x, 0, GFX_LINESIZE_DOUBLE * (SCREEN_YSIZE * 2) * sizeof(ushort));
+}
+#endif
+
+void BenchmarkScrollLayers()
+{
+#if RETRO_SOFTWARE_RENDER
+    // time the same full screen layer drawn as an HScroll and a VScroll layer
+    const int passCount   = 64;
+    BenchmarkStage *stage = new BenchmarkStage;
+    SetupBenchmarkStage(stage);
+    TileLayer *layer = &stageLayouts[1];
+
+    double freq    = (double)SDL_GetPerformanceFrequency() / 1000.0;
+    double time[2] = { 0.0, 0.0 };
+    for (int k = 0; k < 2; ++k) {
+        layer->type              = k ? LAYER_VSCROLL : LAYER_HSCROLL;
+        unsigned long long start = SDL_GetPerformanceCounter();
+        for (int p = 0; p < passCount; ++p) {
+            xScrollOffset = p * 3;
+            yScrollOffset = p * 5;
+            if (k)
+                DrawVLineScrollLayer(0);
+            else
+                DrawHLineScrollLayer(0);
+        }
+        time[k] = (SDL_GetPerformanceCounter() - start) / freq / passCount;
+    }
+    PrintLog("Scroll layer benchmark: HScroll %.4fms, VScroll %.4fms (%.2fx)", time[0], time[1], time[0] > 0.0 ? time[1] / time[0] : 0.0);
+
+    RestoreBenchmarkStage(stage);
+    delete stage;
+#endif
+}
+
+void BenchmarkSpriteSpans()
+{
+#if RETRO_SOFTWARE_RENDER
+    // time the made up sheet drawn whole from the raw pixels & from its spans
+    const int passCount   = 64;
+    BenchmarkStage *stage = new BenchmarkStage;
+    SetupBenchmarkStage(stage);
+    bool useSpriteSpans   = Engine.useSpriteSpans;
+    Engine.useSpriteSpans = true;
+    if (stage->sheetID >= 0)
+        BuildSurfaceSpans(stage->sheetID);
+
+    if (stage->sheetID >= 0 && surfaceSpans[stage->sheetID].spans) {
+        double freq    = (double)SDL_GetPerformanceFrequency() / 1000.0;
+        double time[2] = { 0.0, 0.0 };
+        for (int k = 0; k < 2; ++k) {
+            Engine.useSpriteSpans    = k == 1;
+            unsigned long long start = SDL_GetPerformanceCounter();
+            for (int p = 0; p < passCount; ++p) DrawSprite(p % 5, p % 3, BENCHMARK_SHEET_SIZE, BENCHMARK_SHEET_SIZE, 0, 0, stage->sheetID);
+            time[k] = (SDL_GetPerformanceCounter() - start) / freq / passCount;
+        }
+        PrintLog("Sprite span benchmark: raw %.4fms, spans %.4fms (%.2fx)", time[0], time[1], time[1] > 0.0 ? time[0] / time[1] : 0.0);
+        surfaceSpans[stage->sheetID].visitedPixels = 0;
+        surfaceSpans[stage->sheetID].drawnPixels   = 0;
+    }
+    else {
+        PrintLog("Sprite span benchmark: the benchmark sheet didn't get spans, skipping");
+    }
+    Engine.useSpriteSpans = useSpriteSpans;
+
+    RestoreBenchmarkStage(stage);
+    delete stage;
+#endif
+}
+
+#endif
+
 void ClearScreen(byte index)
 {
 #if RETRO_SOFTWARE_RENDER
+#if !RETRO_USE_ORIGINAL_CODE
+    blendKernels.fill(Engine.frameBuffer, GFX_LINESIZE * SCREEN_YSIZE, activePalette[index]);
+#else
     ushort color        = activePalette[index];
     ushort *framebuffer = Engine.frameBuffer;
     int cnt             = GFX_LINESIZE * SCREEN_YSIZE;
@@ -626,6 +1530,7 @@ void ClearScreen(byte index)
         ++framebuffer;
     }
 #endif
+#endif
 }
 
 void SetScreenDimensions(int width, int height)
@@ -745,6 +1650,13 @@ void CopyFrameOverlay2x()
     ushort *frameBuffer   = &Engine.frameBuffer[((SCREEN_YSIZE / 2) + 12) * GFX_LINESIZE];
     ushort *frameBuffer2x = Engine.frameBuffer2x;
 
+#if !RETRO_USE_ORIGINAL_CODE
+    for (int y = 0; y < (SCREEN_YSIZE / 2) - 12; ++y) {
+        blendKernels.keyedOverlay2x(frameBuffer2x, GFX_LINESIZE_DOUBLE, frameBuffer, GFX_LINESIZE);
+        frameBuffer += GFX_LINESIZE;
+        frameBuffer2x += 2 * GFX_LINESIZE_DOUBLE;
+    }
+#else
     for (int y = 0; y < (SCREEN_YSIZE / 2) - 12; ++y) {
         for (int x = 0; x < GFX_LINESIZE; ++x) {
             if (*frameBuffer == 0xF81F) { // magenta
@@ -773,6 +1685,7 @@ void CopyFrameOverlay2x()
             ++frameBuffer;
         }
     }
+#endif
 }
 #endif
 
@@ -1054,6 +1967,10 @@ void DrawStageGFX()
         waterDrawPos = SCREEN_YSIZE;
 #endif
 
+#if !RETRO_USE_ORIGINAL_CODE
+    PrepareLayerOcclusion();
+#endif
+
     if (tLayerMidPoint < 3) {
         DrawObjectList(0);
 
@@ -1326,80 +2243,1091 @@ void DrawDebugOverlays()
             x                     = (x >> 16) - xScrollOffset;
             y                     = (y >> 16) - yScrollOffset;
 
-            switch (info->type) {
-                case H_TYPE_TOUCH:
-                    if (showHitboxes & 1)
-                        DrawRectangle(x, y, w, h, info->collision ? 0x80 : 0xFF, info->collision ? 0x80 : 0x00, 0x00, 0x60);
-                    break;
+            switch (info->type) {
+                case H_TYPE_TOUCH:
+                    if (showHitboxes & 1)
+                        DrawRectangle(x, y, w, h, info->collision ? 0x80 : 0xFF, info->collision ? 0x80 : 0x00, 0x00, 0x60);
+                    break;
+
+                case H_TYPE_BOX:
+                    if (showHitboxes & 1) {
+                        DrawRectangle(x, y, w, h, 0x00, 0x00, 0xFF, 0x60);
+                        if (info->collision & 1) // top
+                            DrawRectangle(x, y, w, 1, 0xFF, 0xFF, 0x00, 0xC0);
+                        if (info->collision & 8) // bottom
+                            DrawRectangle(x, y + h, w, 1, 0xFF, 0xFF, 0x00, 0xC0);
+                        if (info->collision & 2) { // left
+                            int sy = y;
+                            int sh = h;
+                            if (info->collision & 1) {
+                                sy++;
+                                sh--;
+                            }
+                            if (info->collision & 8)
+                                sh--;
+                            DrawRectangle(x, sy, 1, sh, 0xFF, 0xFF, 0x00, 0xC0);
+                        }
+                        if (info->collision & 4) { // right
+                            int sy = y;
+                            int sh = h;
+                            if (info->collision & 1) {
+                                sy++;
+                                sh--;
+                            }
+                            if (info->collision & 8)
+                                sh--;
+                            DrawRectangle(x + w, sy, 1, sh, 0xFF, 0xFF, 0x00, 0xC0);
+                        }
+                    }
+                    break;
+
+                case H_TYPE_PLAT:
+                    if (showHitboxes & 1) {
+                        DrawRectangle(x, y, w, h, 0x00, 0xFF, 0x00, 0x60);
+                        if (info->collision & 1) // top
+                            DrawRectangle(x, y, w, 1, 0xFF, 0xFF, 0x00, 0xC0);
+                        if (info->collision & 8) // bottom
+                            DrawRectangle(x, y + h, w, 1, 0xFF, 0xFF, 0x00, 0xC0);
+                    }
+                    break;
+
+                case H_TYPE_FINGER:
+                    if (showHitboxes & 2)
+                        DrawRectangle(x + xScrollOffset, y + yScrollOffset, w, h, 0xF0, 0x00, 0xF0, 0x60);
+                    break;
+            }
+        }
+    }
+
+    if (Engine.showPaletteOverlay) {
+        for (int p = 0; p < PALETTE_COUNT; ++p) {
+            int x = (SCREEN_XSIZE - (0x10 << 3));
+            int y = (SCREEN_YSIZE - (0x10 << 2));
+            for (int c = 0; c < PALETTE_COLOR_COUNT; ++c) {
+                int g = fullPalette32[p][c].g;
+                // HQ mode overrides any magenta px, so slightly change the g channel since it has the most bits to make it "not quite magenta"
+                if (drawStageGFXHQ && fullPalette32[p][c].r == 0xFF && fullPalette32[p][c].g == 0x00 && fullPalette32[p][c].b == 0xFF)
+                    g += 8;
+
+                DrawRectangle(x + ((c & 0xF) << 1) + ((p % (PALETTE_COUNT / 2)) * (2 * 16)),
+                              y + ((c >> 4) << 1) + ((p / (PALETTE_COUNT / 2)) * (2 * 16)), 2, 2, fullPalette32[p][c].r, g, fullPalette32[p][c].b,
+                              0xFF);
+            }
+        }
+    }
+}
+#endif
+
+#if !RETRO_USE_ORIGINAL_CODE
+// Worker threads used to split line-independent drawing (tile layers, 3D floor & sky) into horizontal bands
+// each job is split evenly & the calling thread takes the first band, so results are identical to the serial path
+int renderThreadCount = 1;
+
+struct RenderBandJob {
+    void (*job)(void *data, int band, int startLine, int endLine);
+    void *data;
+    int lineCount;
+    int jobID;
+    int pending;
+    bool quit;
+};
+
+RenderBandJob renderBandJob;
+std::thread renderThreads[RENDERTHREAD_COUNT - 1];
+std::mutex renderBandLock;
+std::condition_variable renderBandStart;
+std::condition_variable renderBandDone;
+
+void RenderThreadLoop(int band)
+{
+    int lastJob = 0;
+    std::unique_lock<std::mutex> guard(renderBandLock);
+    for (;;) {
+        while (!renderBandJob.quit && renderBandJob.jobID == lastJob) renderBandStart.wait(guard);
+        if (renderBandJob.quit)
+            return;
+
+        lastJob           = renderBandJob.jobID;
+        RenderBandJob job = renderBandJob;
+        guard.unlock();
+        job.job(job.data, band, job.lineCount * band / renderThreadCount, job.lineCount * (band + 1) / renderThreadCount);
+        guard.lock();
+
+        if (!--renderBandJob.pending)
+            renderBandDone.notify_one();
+    }
+}
+
+void InitRenderThreads(int count)
+{
+    ReleaseRenderThreads();
+    if (count < 1)
+        count = 1;
+    if (count > RENDERTHREAD_COUNT)
+        count = RENDERTHREAD_COUNT;
+
+    renderBandJob.jobID = 0;
+    renderBandJob.quit  = false;
+    renderThreadCount   = count;
+    for (int t = 1; t < renderThreadCount; ++t) renderThreads[t - 1] = std::thread(RenderThreadLoop, t);
+    if (renderThreadCount > 1)
+        PrintLog("Rendering with %d threads", renderThreadCount);
+}
+
+void ReleaseRenderThreads()
+{
+    {
+        std::lock_guard<std::mutex> guard(renderBandLock);
+        renderBandJob.quit = true;
+    }
+    renderBandStart.notify_all();
+    for (int t = 1; t < renderThreadCount; ++t) renderThreads[t - 1].join();
+    renderThreadCount = 1;
+}
+
+void RunRenderBands(void (*job)(void *data, int band, int startLine, int endLine), void *data, int lineCount)
+{
+    if (renderThreadCount <= 1) {
+        job(data, 0, 0, lineCount);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(renderBandLock);
+        renderBandJob.job       = job;
+        renderBandJob.data      = data;
+        renderBandJob.lineCount = lineCount;
+        renderBandJob.pending   = renderThreadCount - 1;
+        renderBandJob.jobID++;
+    }
+    renderBandStart.notify_all();
+
+    job(data, 0, 0, lineCount / renderThreadCount);
+
+    std::unique_lock<std::mutex> guard(renderBandLock);
+    while (renderBandJob.pending) renderBandDone.wait(guard);
+}
+#endif
+
+#if !RETRO_USE_ORIGINAL_CODE
+// Tiles resolved to RGB565 per palette, allocated the first time each palette is drawn with
+// every palette holds all the tiles followed by X-flipped copies of them, Y flips just read a different row
+ushort *tileCache[PALETTE_COUNT];
+uint tileCacheGeneration[PALETTE_COUNT][TILE_COUNT];
+
+void ResetTileCache() { memset(tileCacheGeneration, 0, sizeof(tileCacheGeneration)); }
+
+void InvalidateTileCache(int tileID)
+{
+    for (int p = 0; p < PALETTE_COUNT; ++p) tileCacheGeneration[p][tileID] = 0;
+}
+
+void ReleaseTileCache()
+{
+    for (int p = 0; p < PALETTE_COUNT; ++p) {
+        if (tileCache[p])
+            delete[] tileCache[p];
+        tileCache[p] = NULL;
+    }
+    ResetTileCache();
+}
+
+#if RETRO_SOFTWARE_RENDER
+// returns the resolved row of the tile in [chunk] as it appears on screen, or NULL if the row has transparent pixels
+inline ushort *GetCachedTileRow(int chunk, int row, byte paletteID)
+{
+    int tileID = tiles128x128.gfxDataPos[chunk] / TILE_DATASIZE;
+    if (!Engine.useTileCache || tileID >= TILE_COUNT)
+        return NULL;
+
+    byte direction = tiles128x128.direction[chunk];
+    if (direction & FLIP_Y)
+        row = 0xF - row;
+    if (!(tileRowOpacity[tileID] & (1 << row)))
+        return NULL;
+
+    if (!tileCache[paletteID])
+        tileCache[paletteID] = new ushort[TILESET_SIZE * 2];
+
+    ushort *tilePx = &tileCache[paletteID][tileID * TILE_DATASIZE];
+    if (tileCacheGeneration[paletteID][tileID] != paletteGeneration[paletteID]) {
+        ushort *palette = fullPalette[paletteID];
+        byte *gfxData   = &tilesetGFXData[tileID * TILE_DATASIZE];
+        ushort *flipPx  = &tilePx[TILESET_SIZE];
+        for (int y = 0; y < TILE_SIZE; ++y) {
+            for (int x = 0; x < TILE_SIZE; ++x) {
+                tilePx[x]       = palette[gfxData[x]];
+                flipPx[0xF - x] = tilePx[x];
+            }
+            tilePx += TILE_SIZE;
+            flipPx += TILE_SIZE;
+            gfxData += TILE_SIZE;
+        }
+        tilePx -= TILE_DATASIZE;
+        tileCacheGeneration[paletteID][tileID] = paletteGeneration[paletteID];
+    }
+
+    if (direction & FLIP_X)
+        tilePx += TILESET_SIZE;
+    return &tilePx[row * TILE_SIZE];
+}
+#endif
+#endif
+
+#if !RETRO_USE_ORIGINAL_CODE
+LayerOcclusion layerOcclusion;
+
+#if RETRO_SOFTWARE_RENDER
+inline bool IsTileRowOpaque(int chunk, int row)
+{
+    int tileID = tiles128x128.gfxDataPos[chunk] / TILE_DATASIZE;
+    if (tileID >= TILE_COUNT)
+        return false;
+    if (tiles128x128.direction[chunk] & FLIP_Y)
+        row = 0xF - row;
+    return tileRowOpacity[tileID] & (1 << row);
+}
+
+inline void SetSpanCoverage(uint *line, int x, int count)
+{
+    while (count > 0) {
+        int bit = x & 0x1F;
+        int cnt = 32 - bit < count ? 32 - bit : count;
+        line[x >> 5] |= (cnt == 32 ? 0xFFFFFFFF : ((1u << cnt) - 1)) << bit;
+        x += cnt;
+        count -= cnt;
+    }
+}
+
+inline bool IsSpanCovered(uint *line, int x, int count)
+{
+    while (count > 0) {
+        int bit   = x & 0x1F;
+        int cnt   = 32 - bit < count ? 32 - bit : count;
+        uint mask = (cnt == 32 ? 0xFFFFFFFF : ((1u << cnt) - 1)) << bit;
+        if ((line[x >> 5] & mask) != mask)
+            return false;
+        x += cnt;
+        count -= cnt;
+    }
+    return true;
+}
+
+// Marks every pixel the HScroll layer in [layerID] will draw an opaque tile row over, walking the tiles the same way DrawHLineScrollLayer does
+void AddLayerCoverage(int layerID, uint *coverage)
+{
+    TileLayer *layer   = &stageLayouts[activeTileLayers[layerID]];
+    int screenwidth16  = (GFX_LINESIZE >> 4) - 1;
+    int layerwidth     = layer->xsize;
+    bool aboveMidPoint = layerID >= tLayerMidPoint;
+
+    for (int y = 0; y < SCREEN_YSIZE; ++y) {
+        uint *line  = &coverage[y * layerOcclusion.lineWords];
+        int chunkX  = layerOcclusion.lineXPos[layerID][y];
+        int chunkY  = layerOcclusion.lineYPos[layerID][y] >> 7;
+        int tileY   = (layerOcclusion.lineYPos[layerID][y] & 0x7F) >> 4;
+        int tileY16 = layerOcclusion.lineYPos[layerID][y] & 0xF;
+
+        int chunkXPos  = chunkX >> 7;
+        int chunk      = (layer->tiles[chunkXPos + (chunkY << 8)] << 6) + ((chunkX & 0x7F) >> 4) + 8 * tileY;
+        int lineRemain = GFX_LINESIZE;
+        int x          = 0;
+
+        int tilePxLineCnt = TILE_SIZE - (chunkX & 0xF);
+        if (tiles128x128.visualPlane[chunk] == (byte)aboveMidPoint && IsTileRowOpaque(chunk, tileY16))
+            SetSpanCoverage(line, x, tilePxLineCnt);
+        x += tilePxLineCnt;
+        lineRemain -= tilePxLineCnt;
+
+        int chunkTileX   = ((chunkX & 0x7F) >> 4) + 1;
+        int tilesPerLine = screenwidth16;
+        while (tilesPerLine--) {
+            if (chunkTileX < 8) {
+                ++chunk;
+            }
+            else {
+                if (++chunkXPos == layerwidth)
+                    chunkXPos = 0;
+
+                chunkTileX = 0;
+                chunk      = (layer->tiles[chunkXPos + (chunkY << 8)] << 6) + 8 * tileY;
+            }
+            lineRemain -= TILE_SIZE;
+
+            if (tiles128x128.visualPlane[chunk] == (byte)aboveMidPoint && IsTileRowOpaque(chunk, tileY16))
+                SetSpanCoverage(line, x, TILE_SIZE);
+            x += TILE_SIZE;
+            ++chunkTileX;
+        }
+
+        while (lineRemain > 0) {
+            if (chunkTileX++ < 8) {
+                ++chunk;
+            }
+            else {
+                chunkTileX = 0;
+                if (++chunkXPos == layerwidth)
+                    chunkXPos = 0;
+
+                chunk = (layer->tiles[chunkXPos + (chunkY << 8)] << 6) + 8 * tileY;
+            }
+
+            tilePxLineCnt = lineRemain >= TILE_SIZE ? TILE_SIZE : lineRemain;
+            lineRemain -= tilePxLineCnt;
+            if (tiles128x128.visualPlane[chunk] == (byte)aboveMidPoint && IsTileRowOpaque(chunk, tileY16))
+                SetSpanCoverage(line, x, tilePxLineCnt);
+            x += tilePxLineCnt;
+        }
+    }
+}
+#endif
+
+// Draw scripts can move, retile or swap out any layer, so a layer only covers the ones under it when no draw script runs between them.
+// these are the draw lists DrawStageGFX runs after layer [layerID] & before the next one, so they have to be kept in step with it
+inline bool DrawListsAfterLayerRunScripts(int layerID)
+{
+    int first = layerID + 1;
+    int last  = layerID + 1;
+    if (layerID == 1)
+        last = tLayerMidPoint < 3 ? 4 : 2;
+    else if (layerID == 2)
+        last = tLayerMidPoint < 3 ? 2 : 4;
+    else if (layerID > 2)
+        last = layerID;
+
+    for (int l = first; l <= last; ++l) {
+        for (int i = 0; i < drawListEntries[l].listSize; ++i) {
+            int type = objectEntityList[drawListEntries[l].entityRefs[i]].type;
+            if (type && scriptData[objectScriptList[type].eventDraw.scriptCodePtr] > 0)
+                return true;
+        }
+    }
+    return false;
+}
+
+// Marks the pixels the HScroll layers drawn after [layerID] will draw over, working out where they'll land from how things stand now,
+// just before [layerID] is drawn. the walk stops at the first draw list that runs a draw script, since anything after it could change,
+// and at a 3D sky, which copies what's under it into the HQ buffer
+uint *PrepareLayerCoverage(int layerID)
+{
+    uint *coverage = NULL;
+#if RETRO_SOFTWARE_RENDER
+    // setting up a layer also advances its scrolling, so run them in draw order then put everything back how it was
+    int lastXSizeStore = lastXSize;
+    int linePosStore[PARALLAX_COUNT];
+    int scrollPosStore[PARALLAX_COUNT];
+    int layerScrollStore[LAYER_COUNT];
+    memcpy(linePosStore, hParallax.linePos, sizeof(linePosStore));
+    memcpy(scrollPosStore, hParallax.scrollPos, sizeof(scrollPosStore));
+    for (int i = 0; i < LAYER_COUNT; ++i) layerScrollStore[i] = stageLayouts[i].scrollPos;
+
+    for (int l = layerID + 1; l < 4; ++l) {
+        if (DrawListsAfterLayerRunScripts(l - 1) || activeTileLayers[l] >= LAYER_COUNT)
+            break;
+
+        TileLayer *layer = &stageLayouts[activeTileLayers[l]];
+        if (layer->type == LAYER_3DSKY)
+            break;
+        if (layer->type != LAYER_HSCROLL || !layer->xsize || !layer->ysize)
+            continue;
+
+        if (!coverage) {
+            coverage = layerOcclusion.coverage;
+            memset(coverage, 0, layerOcclusion.lineWords * SCREEN_YSIZE * sizeof(uint));
+        }
+        SetupHLineScrollLayer(l, layerOcclusion.lineXPos[l], layerOcclusion.lineYPos[l]);
+        AddLayerCoverage(l, coverage);
+        layerOcclusion.predicted[l] = true;
+    }
+
+    lastXSize = lastXSizeStore;
+    memcpy(hParallax.linePos, linePosStore, sizeof(linePosStore));
+    memcpy(hParallax.scrollPos, scrollPosStore, sizeof(scrollPosStore));
+    for (int i = 0; i < LAYER_COUNT; ++i) stageLayouts[i].scrollPos = layerScrollStore[i];
+#endif
+    return coverage;
+}
+
+// Starts a frame of layer occlusion, the coverage itself is worked out as each layer's drawn
+void PrepareLayerOcclusion()
+{
+    layerOcclusion.active = false;
+#if RETRO_SOFTWARE_RENDER
+    if (++layerOcclusion.frameCount >= 60) {
+        for (int l = 0; l < 4; ++l) {
+            if (engineDebugMode && layerOcclusion.drawnPixels[l])
+                PrintLog("Layer %d: skipped %d%% of tile pixels", l, (int)(layerOcclusion.skippedPixels[l] * 100 / layerOcclusion.drawnPixels[l]));
+            layerOcclusion.drawnPixels[l]   = 0;
+            layerOcclusion.skippedPixels[l] = 0;
+        }
+        layerOcclusion.frameCount = 0;
+    }
+
+    if (!Engine.useLayerOcclusion || layerOcclusion.failed)
+        return;
+
+    int lineWords = (GFX_LINESIZE + 0x1F) >> 5;
+    if (layerOcclusion.lineWords != lineWords) {
+        ReleaseLayerOcclusion();
+        layerOcclusion.lineWords = lineWords;
+    }
+    if (!layerOcclusion.coverage)
+        layerOcclusion.coverage = new uint[lineWords * SCREEN_YSIZE];
+
+    memset(layerOcclusion.predicted, 0, sizeof(layerOcclusion.predicted));
+    layerOcclusion.active = true;
+#endif
+}
+
+void ReleaseLayerOcclusion()
+{
+    if (layerOcclusion.coverage)
+        delete[] layerOcclusion.coverage;
+    layerOcclusion.coverage = NULL;
+}
+
+// Updates the layer's scrolling & works out which layer pixel each screen line starts at
+void SetupHLineScrollLayer(int layerID, int *lineXPos, int *lineYPos)
+{
+    TileLayer *layer = &stageLayouts[activeTileLayers[layerID]];
+    int layerwidth   = layer->xsize;
+    int layerheight  = layer->ysize;
+
+    byte *lineScroll;
+    int *deformationData;
+    int *deformationDataW;
+
+    int yscrollOffset = 0;
+    if (activeTileLayers[layerID]) { // BG Layer
+        int yScroll    = yScrollOffset * layer->parallaxFactor >> 8;
+        int fullheight = layerheight << 7;
+        layer->scrollPos += layer->scrollSpeed;
+        if (layer->scrollPos > fullheight << 16)
+            layer->scrollPos -= fullheight << 16;
+        yscrollOffset    = (yScroll + (layer->scrollPos >> 16)) % fullheight;
+        layerheight      = fullheight >> 7;
+        lineScroll       = layer->lineScroll;
+        deformationData  = &bgDeformationData2[(byte)(yscrollOffset + layer->deformationOffset)];
+        deformationDataW = &bgDeformationData3[(byte)(yscrollOffset + waterDrawPos + layer->deformationOffsetW)];
+    }
+    else { // FG Layer
+        lastXSize     = layer->xsize;
+        yscrollOffset = yScrollOffset;
+        lineScroll    = layer->lineScroll;
+        for (int i = 0; i < PARALLAX_COUNT; ++i) hParallax.linePos[i] = xScrollOffset;
+        deformationData  = &bgDeformationData0[(byte)(yscrollOffset + layer->deformationOffset)];
+        deformationDataW = &bgDeformationData1[(byte)(yscrollOffset + waterDrawPos + layer->deformationOffsetW)];
+    }
+
+    if (layer->type == LAYER_HSCROLL) {
+        if (lastXSize != layerwidth) {
+            int fullLayerwidth = layerwidth << 7;
+            for (int i = 0; i < hParallax.entryCount; ++i) {
+                hParallax.linePos[i] = xScrollOffset * hParallax.parallaxFactor[i] >> 8;
+                if (hParallax.scrollPos[i] > fullLayerwidth << 16)
+                    hParallax.scrollPos[i] -= fullLayerwidth << 16;
+                if (hParallax.scrollPos[i] < 0)
+                    hParallax.scrollPos[i] += fullLayerwidth << 16;
+                hParallax.linePos[i] += hParallax.scrollPos[i] >> 16;
+                hParallax.linePos[i] %= fullLayerwidth;
+            }
+        }
+        int w = -1;
+        if (activeTileLayers[layerID])
+            w = layerwidth;
+        lastXSize = w;
+    }
+
+    int fullLayerwidth  = layerwidth << 7;
+    int fullLayerheight = layerheight << 7;
+    int tileYPos        = yscrollOffset % fullLayerheight;
+    if (tileYPos < 0)
+        tileYPos += fullLayerheight;
+    byte *scrollIndex = &lineScroll[tileYPos];
+
+    // Above Water (if applicable), then below it
+    int drawableLines[2] = { waterDrawPos, SCREEN_YSIZE - waterDrawPos };
+    for (int i = 0; i < 2; ++i) {
+        while (drawableLines[i]--) {
+            int chunkX = hParallax.linePos[*scrollIndex];
+            if (i == 0) {
+                if (hParallax.deform[*scrollIndex])
+                    chunkX += *deformationData;
+                ++deformationData;
+            }
+            else {
+                if (hParallax.deform[*scrollIndex])
+                    chunkX += *deformationDataW;
+                ++deformationDataW;
+            }
+            ++scrollIndex;
+
+            if (chunkX < 0)
+                chunkX += fullLayerwidth;
+            if (chunkX >= fullLayerwidth)
+                chunkX -= fullLayerwidth;
+
+            *lineXPos++ = chunkX;
+            *lineYPos++ = tileYPos;
+            if (++tileYPos == fullLayerheight) {
+                tileYPos    = 0;
+                scrollIndex = lineScroll;
+            }
+        }
+    }
+}
+
+#if RETRO_SOFTWARE_RENDER
+struct HLineScrollJob {
+    int layerID;
+    int lineXPos[SCREEN_YSIZE];
+    int lineYPos[SCREEN_YSIZE];
+    uint *coverage;
+    bool useTileCache;
+    int drawnPixels[RENDERTHREAD_COUNT];
+    int skippedPixels[RENDERTHREAD_COUNT];
+};
+
+void DrawHLineScrollBand(void *data, int band, int startLine, int endLine)
+{
+    HLineScrollJob *job = (HLineScrollJob *)data;
+    TileLayer *layer    = &stageLayouts[activeTileLayers[job->layerID]];
+    int screenwidth16   = (GFX_LINESIZE >> 4) - 1;
+    int layerwidth      = layer->xsize;
+    bool aboveMidPoint  = job->layerID >= tLayerMidPoint;
+
+    ushort *frameBufferPtr = &Engine.frameBuffer[startLine * GFX_LINESIZE];
+    byte *lineBuffer       = &gfxLineBuffer[startLine];
+    for (int y = startLine; y < endLine; ++y) {
+        byte paletteID      = *lineBuffer;
+        ushort *linePalette = fullPalette[*lineBuffer];
+        lineBuffer++;
+
+        int chunkX  = job->lineXPos[y];
+        int chunkY  = job->lineYPos[y] >> 7;
+        int tileY   = (job->lineYPos[y] & 0x7F) >> 4;
+        int tileY16 = job->lineYPos[y] & 0xF;
+        ushort *lineStart  = frameBufferPtr;
+        uint *lineCoverage = job->coverage ? &job->coverage[y * layerOcclusion.lineWords] : NULL;
+        int chunkXPos         = chunkX >> 7;
+        int tilePxXPos        = chunkX & 0xF;
+        int tileXPxRemain     = TILE_SIZE - tilePxXPos;
+        int chunk             = (layer->tiles[(chunkX >> 7) + (chunkY << 8)] << 6) + ((chunkX & 0x7F) >> 4) + 8 * tileY;
+        int tileOffsetY       = TILE_SIZE * tileY16;
+        int tileOffsetYFlipX  = TILE_SIZE * tileY16 + 0xF;
+        int tileOffsetYFlipY  = TILE_SIZE * (0xF - tileY16);
+        int tileOffsetYFlipXY = TILE_SIZE * (0xF - tileY16) + 0xF;
+        int lineRemain        = GFX_LINESIZE;
+
+        byte *gfxDataPtr  = NULL;
+        int tilePxLineCnt = tileXPxRemain;
+
+        // Draw the first tile to the left
+        if (tiles128x128.visualPlane[chunk] == (byte)aboveMidPoint) {
+            lineRemain -= tilePxLineCnt;
+            job->drawnPixels[band] += tilePxLineCnt;
+            ushort *cachedRow = NULL;
+            if (lineCoverage && IsSpanCovered(lineCoverage, (int)(frameBufferPtr - lineStart), tilePxLineCnt)) {
+                job->skippedPixels[band] += tilePxLineCnt;
+                frameBufferPtr += tilePxLineCnt;
+            }
+            else if (job->useTileCache && (cachedRow = GetCachedTileRow(chunk, tileY16, paletteID))) {
+                memcpy(frameBufferPtr, &cachedRow[tilePxXPos], tilePxLineCnt * sizeof(ushort));
+                frameBufferPtr += tilePxLineCnt;
+            }
+            else
+            switch (tiles128x128.direction[chunk]) {
+                case FLIP_NONE:
+                    gfxDataPtr = &tilesetGFXData[tileOffsetY + tiles128x128.gfxDataPos[chunk] + tilePxXPos];
+                    while (tilePxLineCnt--) {
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+                    }
+                    break;
+                case FLIP_X:
+
+                    gfxDataPtr = &tilesetGFXData[tileOffsetYFlipX + tiles128x128.gfxDataPos[chunk] - tilePxXPos];
+                    while (tilePxLineCnt--) {
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+                    }
+                    break;
+
+                case FLIP_Y:
+                    gfxDataPtr = &tilesetGFXData[tileOffsetYFlipY + tiles128x128.gfxDataPos[chunk] + tilePxXPos];
+                    while (tilePxLineCnt--) {
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+                    }
+                    break;
+
+                case FLIP_XY:
+                    gfxDataPtr = &tilesetGFXData[tileOffsetYFlipXY + tiles128x128.gfxDataPos[chunk] - tilePxXPos];
+                    while (tilePxLineCnt--) {
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+                    }
+                    break;
+                default: break;
+            }
+        }
+        else {
+            frameBufferPtr += tilePxLineCnt;
+            lineRemain -= tilePxLineCnt;
+        }
+
+        // Draw the bulk of the tiles
+        int chunkTileX   = ((chunkX & 0x7F) >> 4) + 1;
+        int tilesPerLine = screenwidth16;
+        while (tilesPerLine--) {
+            if (chunkTileX < 8) {
+                ++chunk;
+            }
+            else {
+                if (++chunkXPos == layerwidth)
+                    chunkXPos = 0;
+
+                chunkTileX = 0;
+                chunk      = (layer->tiles[chunkXPos + (chunkY << 8)] << 6) + 8 * tileY;
+            }
+            lineRemain -= TILE_SIZE;
+
+            // Loop Unrolling (faster but messier code)
+            if (tiles128x128.visualPlane[chunk] == (byte)aboveMidPoint) {
+                job->drawnPixels[band] += TILE_SIZE;
+                ushort *cachedRow = NULL;
+                if (lineCoverage && IsSpanCovered(lineCoverage, (int)(frameBufferPtr - lineStart), TILE_SIZE)) {
+                    job->skippedPixels[band] += TILE_SIZE;
+                    frameBufferPtr += TILE_SIZE;
+                }
+                else if (job->useTileCache && (cachedRow = GetCachedTileRow(chunk, tileY16, paletteID))) {
+                    memcpy(frameBufferPtr, cachedRow, TILE_SIZE * sizeof(ushort));
+                    frameBufferPtr += TILE_SIZE;
+                }
+                else
+                switch (tiles128x128.direction[chunk]) {
+                    case FLIP_NONE:
+                        gfxDataPtr = &tilesetGFXData[tiles128x128.gfxDataPos[chunk] + tileOffsetY];
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        break;
+
+                    case FLIP_X:
+                        gfxDataPtr = &tilesetGFXData[tiles128x128.gfxDataPos[chunk] + tileOffsetYFlipX];
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        break;
+
+                    case FLIP_Y:
+                        gfxDataPtr = &tilesetGFXData[tiles128x128.gfxDataPos[chunk] + tileOffsetYFlipY];
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        ++gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        break;
+
+                    case FLIP_XY:
+                        gfxDataPtr = &tilesetGFXData[tiles128x128.gfxDataPos[chunk] + tileOffsetYFlipXY];
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        --gfxDataPtr;
+
+                        if (*gfxDataPtr > 0)
+                            *frameBufferPtr = linePalette[*gfxDataPtr];
+                        ++frameBufferPtr;
+                        break;
+                }
+            }
+            else {
+                frameBufferPtr += TILE_SIZE;
+            }
+            ++chunkTileX;
+        }
+
+        // Draw any remaining tiles
+        while (lineRemain > 0) {
+            if (chunkTileX++ < 8) {
+                ++chunk;
+            }
+            else {
+                chunkTileX = 0;
+                if (++chunkXPos == layerwidth)
+                    chunkXPos = 0;
 
-                case H_TYPE_BOX:
-                    if (showHitboxes & 1) {
-                        DrawRectangle(x, y, w, h, 0x00, 0x00, 0xFF, 0x60);
-                        if (info->collision & 1) // top
-                            DrawRectangle(x, y, w, 1, 0xFF, 0xFF, 0x00, 0xC0);
-                        if (info->collision & 8) // bottom
-                            DrawRectangle(x, y + h, w, 1, 0xFF, 0xFF, 0x00, 0xC0);
-                        if (info->collision & 2) { // left
-                            int sy = y;
-                            int sh = h;
-                            if (info->collision & 1) {
-                                sy++;
-                                sh--;
-                            }
-                            if (info->collision & 8)
-                                sh--;
-                            DrawRectangle(x, sy, 1, sh, 0xFF, 0xFF, 0x00, 0xC0);
-                        }
-                        if (info->collision & 4) { // right
-                            int sy = y;
-                            int sh = h;
-                            if (info->collision & 1) {
-                                sy++;
-                                sh--;
-                            }
-                            if (info->collision & 8)
-                                sh--;
-                            DrawRectangle(x + w, sy, 1, sh, 0xFF, 0xFF, 0x00, 0xC0);
+                chunk = (layer->tiles[chunkXPos + (chunkY << 8)] << 6) + 8 * tileY;
+            }
+
+            tilePxLineCnt = lineRemain >= TILE_SIZE ? TILE_SIZE : lineRemain;
+            lineRemain -= tilePxLineCnt;
+            if (tiles128x128.visualPlane[chunk] == (byte)aboveMidPoint) {
+                job->drawnPixels[band] += tilePxLineCnt;
+                ushort *cachedRow = NULL;
+                if (lineCoverage && IsSpanCovered(lineCoverage, (int)(frameBufferPtr - lineStart), tilePxLineCnt)) {
+                    job->skippedPixels[band] += tilePxLineCnt;
+                    frameBufferPtr += tilePxLineCnt;
+                }
+                else if (job->useTileCache && (cachedRow = GetCachedTileRow(chunk, tileY16, paletteID))) {
+                    memcpy(frameBufferPtr, cachedRow, tilePxLineCnt * sizeof(ushort));
+                    frameBufferPtr += tilePxLineCnt;
+                }
+                else
+                switch (tiles128x128.direction[chunk]) {
+                    case FLIP_NONE:
+                        gfxDataPtr = &tilesetGFXData[tiles128x128.gfxDataPos[chunk] + tileOffsetY];
+                        while (tilePxLineCnt--) {
+                            if (*gfxDataPtr > 0)
+                                *frameBufferPtr = linePalette[*gfxDataPtr];
+                            ++frameBufferPtr;
+                            ++gfxDataPtr;
                         }
-                    }
-                    break;
+                        break;
 
-                case H_TYPE_PLAT:
-                    if (showHitboxes & 1) {
-                        DrawRectangle(x, y, w, h, 0x00, 0xFF, 0x00, 0x60);
-                        if (info->collision & 1) // top
-                            DrawRectangle(x, y, w, 1, 0xFF, 0xFF, 0x00, 0xC0);
-                        if (info->collision & 8) // bottom
-                            DrawRectangle(x, y + h, w, 1, 0xFF, 0xFF, 0x00, 0xC0);
-                    }
-                    break;
+                    case FLIP_X:
+                        gfxDataPtr = &tilesetGFXData[tiles128x128.gfxDataPos[chunk] + tileOffsetYFlipX];
+                        while (tilePxLineCnt--) {
+                            if (*gfxDataPtr > 0)
+                                *frameBufferPtr = linePalette[*gfxDataPtr];
+                            ++frameBufferPtr;
+                            --gfxDataPtr;
+                        }
+                        break;
 
-                case H_TYPE_FINGER:
-                    if (showHitboxes & 2)
-                        DrawRectangle(x + xScrollOffset, y + yScrollOffset, w, h, 0xF0, 0x00, 0xF0, 0x60);
-                    break;
-            }
-        }
-    }
+                    case FLIP_Y:
+                        gfxDataPtr = &tilesetGFXData[tiles128x128.gfxDataPos[chunk] + tileOffsetYFlipY];
+                        while (tilePxLineCnt--) {
+                            if (*gfxDataPtr > 0)
+                                *frameBufferPtr = linePalette[*gfxDataPtr];
+                            ++frameBufferPtr;
+                            ++gfxDataPtr;
+                        }
+                        break;
 
-    if (Engine.showPaletteOverlay) {
-        for (int p = 0; p < PALETTE_COUNT; ++p) {
-            int x = (SCREEN_XSIZE - (0x10 << 3));
-            int y = (SCREEN_YSIZE - (0x10 << 2));
-            for (int c = 0; c < PALETTE_COLOR_COUNT; ++c) {
-                int g = fullPalette32[p][c].g;
-                // HQ mode overrides any magenta px, so slightly change the g channel since it has the most bits to make it "not quite magenta"
-                if (drawStageGFXHQ && fullPalette32[p][c].r == 0xFF && fullPalette32[p][c].g == 0x00 && fullPalette32[p][c].b == 0xFF)
-                    g += 8;
+                    case FLIP_XY:
+                        gfxDataPtr = &tilesetGFXData[tiles128x128.gfxDataPos[chunk] + tileOffsetYFlipXY];
+                        while (tilePxLineCnt--) {
+                            if (*gfxDataPtr > 0)
+                                *frameBufferPtr = linePalette[*gfxDataPtr];
+                            ++frameBufferPtr;
+                            --gfxDataPtr;
+                        }
+                        break;
 
-                DrawRectangle(x + ((c & 0xF) << 1) + ((p % (PALETTE_COUNT / 2)) * (2 * 16)),
-                              y + ((c >> 4) << 1) + ((p / (PALETTE_COUNT / 2)) * (2 * 16)), 2, 2, fullPalette32[p][c].r, g, fullPalette32[p][c].b,
-                              0xFF);
+                    default: break;
+                }
+            }
+            else {
+                frameBufferPtr += tilePxLineCnt;
             }
         }
     }
 }
 #endif
+#endif
 
 void DrawHLineScrollLayer(int layerID)
 {
@@ -1408,6 +3336,41 @@ void DrawHLineScrollLayer(int layerID)
         return;
 
 #if RETRO_SOFTWARE_RENDER
+#if !RETRO_USE_ORIGINAL_CODE
+    HLineScrollJob job;
+    job.layerID = layerID;
+    SetupHLineScrollLayer(layerID, job.lineXPos, job.lineYPos);
+
+    job.coverage = NULL;
+    if (layerOcclusion.active) {
+        if (layerOcclusion.predicted[layerID]
+            && (memcmp(job.lineXPos, layerOcclusion.lineXPos[layerID], sizeof(job.lineXPos))
+                || memcmp(job.lineYPos, layerOcclusion.lineYPos[layerID], sizeof(job.lineYPos)))) {
+            // nothing that runs between the layers should be able to move it, so stop trusting the predictions for the rest of the stage
+            PrintLog("Layer %d didn't land where layer occlusion expected, disabling layer occlusion until the next stage load", layerID);
+            layerOcclusion.failed = true;
+            layerOcclusion.active = false;
+        }
+        else {
+            job.coverage = PrepareLayerCoverage(layerID);
+        }
+        layerOcclusion.predicted[layerID] = false;
+    }
+    // the tile cache fills itself in as it's read, so only the serial path can use it
+    job.useTileCache = Engine.useTileCache && renderThreadCount <= 1;
+    memset(job.drawnPixels, 0, sizeof(job.drawnPixels));
+    memset(job.skippedPixels, 0, sizeof(job.skippedPixels));
+
+    RunRenderBands(DrawHLineScrollBand, &job, SCREEN_YSIZE);
+    if (engineDebugMode && Engine.useLayerOcclusion) {
+        for (int b = 0; b < RENDERTHREAD_COUNT; ++b) {
+            layerOcclusion.drawnPixels[layerID] += job.drawnPixels[b];
+            layerOcclusion.skippedPixels[layerID] += job.skippedPixels[b];
+        }
+    }
+    activePalette   = fullPalette[gfxLineBuffer[SCREEN_YSIZE - 1]];
+    activePalette32 = fullPalette32[gfxLineBuffer[SCREEN_YSIZE - 1]];
+#else
     int screenwidth16  = (GFX_LINESIZE >> 4) - 1;
     int layerwidth     = layer->xsize;
     int layerheight    = layer->ysize;
@@ -1992,7 +3955,9 @@ void DrawHLineScrollLayer(int layerID)
         }
     }
 #endif
+#endif
 }
+
 void DrawVLineScrollLayer(int layerID)
 {
     TileLayer *layer = &stageLayouts[activeTileLayers[layerID]];
@@ -2574,50 +4539,61 @@ void DrawVLineScrollLayer(int layerID)
     }
 #endif
 }
-void Draw3DFloorLayer(int layerID)
+#if RETRO_SOFTWARE_RENDER
+// The last 3D floor tile sampled, since neighbouring pixels usually land in the same tile
+struct Mode7Tile {
+    int id;
+    byte *gfxData;
+    byte flipMask;
+    byte pixelMask;
+};
+
+inline byte GetMode7Pixel(Mode7Tile *tile, int tileID, int tileX, int tileY)
 {
-    TileLayer *layer = &stageLayouts[activeTileLayers[layerID]];
-    if (!layer->xsize || !layer->ysize)
-        return;
+    if (tileID != tile->id) {
+        int chunk       = tile3DFloorBuffer[tileID];
+        byte direction  = tiles128x128.direction[chunk];
+        tile->id        = tileID;
+        tile->gfxData   = &tilesetGFXData[tiles128x128.gfxDataPos[chunk]];
+        tile->flipMask  = (direction & FLIP_X ? 0x0F : 0x00) | (direction & FLIP_Y ? 0xF0 : 0x00);
+        tile->pixelMask = direction <= FLIP_XY ? 0xFF : 0x00;
+    }
+    // flipping a 0-15 coordinate is the same as xoring it with 15
+    return tile->gfxData[((((tileY & 0xF) << 4) | (tileX & 0xF)) ^ tile->flipMask) & tile->pixelMask];
+}
 
-#if RETRO_SOFTWARE_RENDER
-    int layerWidth         = layer->xsize << 7;
-    int layerHeight        = layer->ysize << 7;
-    int layerYPos          = layer->ypos;
-    int layerZPos          = layer->zpos;
-    int sinValue           = sinM7LookupTable[layer->angle];
-    int cosValue           = cosM7LookupTable[layer->angle];
-    byte *gfxLineBufferPtr = &gfxLineBuffer[(SCREEN_YSIZE / 2) + 12];
-    ushort *frameBufferPtr = &Engine.frameBuffer[((SCREEN_YSIZE / 2) + 12) * GFX_LINESIZE];
-    int layerXPos          = layer->xpos >> 4;
-    int ZBuffer            = layerZPos >> 4;
-    for (int i = 4; i < 112; ++i) {
-        if (!(i & 1)) {
-            activePalette   = fullPalette[*gfxLineBufferPtr];
-            activePalette32 = fullPalette32[*gfxLineBufferPtr];
-            gfxLineBufferPtr++;
-        }
-        int XBuffer    = layerYPos / (i << 9) * -cosValue >> 8;
-        int YBuffer    = sinValue * (layerYPos / (i << 9)) >> 8;
-        int XPos       = layerXPos + (3 * sinValue * (layerYPos / (i << 9)) >> 2) - XBuffer * SCREEN_CENTERX;
-        int YPos       = ZBuffer + (3 * cosValue * (layerYPos / (i << 9)) >> 2) - YBuffer * SCREEN_CENTERX;
+void Draw3DFloorBand(void *data, int band, int startLine, int endLine)
+{
+    TileLayer *layer = &stageLayouts[activeTileLayers[*(int *)data]];
+    int layerWidth   = layer->xsize << 7;
+    int layerHeight  = layer->ysize << 7;
+    int layerYPos    = layer->ypos;
+    int layerZPos    = layer->zpos;
+    int sinValue     = sinM7LookupTable[layer->angle];
+    int cosValue     = cosM7LookupTable[layer->angle];
+    int layerXPos    = layer->xpos >> 4;
+    int ZBuffer      = layerZPos >> 4;
+    // each palette line covers 2 floor lines
+    for (int i = 4 + startLine; i < 4 + endLine; ++i) {
+        ushort *linePalette    = fullPalette[gfxLineBuffer[(SCREEN_YSIZE / 2) + 12 + ((i - 4) >> 1)]];
+        ushort *frameBufferPtr = &Engine.frameBuffer[((SCREEN_YSIZE / 2) + 12 + (i - 4)) * GFX_LINESIZE];
+
+        int depth      = layerYPos / (i << 9);
+        int XBuffer    = depth * -cosValue >> 8;
+        int YBuffer    = sinValue * depth >> 8;
+        int XPos       = layerXPos + (3 * sinValue * depth >> 2) - XBuffer * SCREEN_CENTERX;
+        int YPos       = ZBuffer + (3 * cosValue * depth >> 2) - YBuffer * SCREEN_CENTERX;
         int lineBuffer = 0;
+
+        Mode7Tile tile;
+        tile.id = -1;
         while (lineBuffer < GFX_LINESIZE) {
             int tileX = XPos >> 12;
             int tileY = YPos >> 12;
             if (tileX > -1 && tileX < layerWidth && tileY > -1 && tileY < layerHeight) {
-                int chunk       = tile3DFloorBuffer[(YPos >> 16 << 8) + (XPos >> 16)];
-                byte *tilePixel = &tilesetGFXData[tiles128x128.gfxDataPos[chunk]];
-                switch (tiles128x128.direction[chunk]) {
-                    case FLIP_NONE: tilePixel += 16 * (tileY & 0xF) + (tileX & 0xF); break;
-                    case FLIP_X: tilePixel += 16 * (tileY & 0xF) + 15 - (tileX & 0xF); break;
-                    case FLIP_Y: tilePixel += (tileX & 0xF) + SCREEN_YSIZE - 16 * (tileY & 0xF); break;
-                    case FLIP_XY: tilePixel += 15 - (tileX & 0xF) + SCREEN_YSIZE - 16 * (tileY & 0xF); break;
-                    default: break;
-                }
-
-                if (*tilePixel > 0)
-                    *frameBufferPtr = activePalette[*tilePixel];
+                byte index = GetMode7Pixel(&tile, (YPos >> 16 << 8) + (XPos >> 16), tileX, tileY);
+                if (index > 0)
+                    *frameBufferPtr = linePalette[index];
             }
             ++frameBufferPtr;
             ++lineBuffer;
@@ -2625,54 +4601,43 @@ void Draw3DFloorLayer(int layerID)
             YPos += YBuffer;
         }
     }
-#endif
 }
-void Draw3DSkyLayer(int layerID)
-{
-    TileLayer *layer = &stageLayouts[activeTileLayers[layerID]];
-    if (!layer->xsize || !layer->ysize)
-        return;
 
-#if RETRO_SOFTWARE_RENDER
-    int layerWidth         = layer->xsize << 7;
-    int layerHeight        = layer->ysize << 7;
-    int layerYPos          = layer->ypos;
-    int sinValue           = sinM7LookupTable[layer->angle & 0x1FF];
-    int cosValue           = cosM7LookupTable[layer->angle & 0x1FF];
-    ushort *frameBufferPtr = &Engine.frameBuffer[((SCREEN_YSIZE / 2) + 12) * GFX_LINESIZE];
-    ushort *bufferPtr      = Engine.frameBuffer2x;
-    if (!drawStageGFXHQ)
-        bufferPtr = &Engine.frameBuffer[((SCREEN_YSIZE / 2) + 12) * GFX_LINESIZE];
-    byte *gfxLineBufferPtr = &gfxLineBuffer[((SCREEN_YSIZE / 2) + 12)];
-    int layerXPos          = layer->xpos >> 4;
-    int layerZPos          = layer->zpos >> 4;
-    for (int i = TILE_SIZE / 2; i < SCREEN_YSIZE - TILE_SIZE; ++i) {
-        if (!(i & 1)) {
-            activePalette   = fullPalette[*gfxLineBufferPtr];
-            activePalette32 = fullPalette32[*gfxLineBufferPtr];
-            gfxLineBufferPtr++;
-        }
-        int xBuffer    = layerYPos / (i << 8) * -cosValue >> 9;
-        int yBuffer    = sinValue * (layerYPos / (i << 8)) >> 9;
-        int XPos       = layerXPos + (3 * sinValue * (layerYPos / (i << 8)) >> 2) - xBuffer * GFX_LINESIZE;
-        int YPos       = layerZPos + (3 * cosValue * (layerYPos / (i << 8)) >> 2) - yBuffer * GFX_LINESIZE;
+// bands are split by pairs of lines, since both lines of a pair draw to the same framebuffer line (outside of HQ mode)
+void Draw3DSkyBand(void *data, int band, int startLine, int endLine)
+{
+    TileLayer *layer = &stageLayouts[activeTileLayers[*(int *)data]];
+    int layerWidth   = layer->xsize << 7;
+    int layerHeight  = layer->ysize << 7;
+    int layerYPos    = layer->ypos;
+    int sinValue     = sinM7LookupTable[layer->angle & 0x1FF];
+    int cosValue     = cosM7LookupTable[layer->angle & 0x1FF];
+    int layerXPos    = layer->xpos >> 4;
+    int layerZPos    = layer->zpos >> 4;
+    for (int i = TILE_SIZE / 2 + 2 * startLine; i < TILE_SIZE / 2 + 2 * endLine; ++i) {
+        int line               = (SCREEN_YSIZE / 2) + 12 + ((i - TILE_SIZE / 2) >> 1);
+        ushort *linePalette    = fullPalette[gfxLineBuffer[line]];
+        ushort *frameBufferPtr = &Engine.frameBuffer[line * GFX_LINESIZE];
+        ushort *bufferPtr      = frameBufferPtr;
+        if (drawStageGFXHQ)
+            bufferPtr = &Engine.frameBuffer2x[(i - TILE_SIZE / 2) * GFX_LINESIZE_DOUBLE];
+
+        int depth      = layerYPos / (i << 8);
+        int xBuffer    = depth * -cosValue >> 9;
+        int yBuffer    = sinValue * depth >> 9;
+        int XPos       = layerXPos + (3 * sinValue * depth >> 2) - xBuffer * GFX_LINESIZE;
+        int YPos       = layerZPos + (3 * cosValue * depth >> 2) - yBuffer * GFX_LINESIZE;
         int lineBuffer = 0;
+
+        Mode7Tile tile;
+        tile.id = -1;
         while (lineBuffer < GFX_LINESIZE * 2) {
             int tileX = XPos >> 12;
             int tileY = YPos >> 12;
             if (tileX > -1 && tileX < layerWidth && tileY > -1 && tileY < layerHeight) {
-                int chunk       = tile3DFloorBuffer[(YPos >> 16 << 8) + (XPos >> 16)];
-                byte *tilePixel = &tilesetGFXData[tiles128x128.gfxDataPos[chunk]];
-                switch (tiles128x128.direction[chunk]) {
-                    case FLIP_NONE: tilePixel += TILE_SIZE * (tileY & 0xF) + (tileX & 0xF); break;
-                    case FLIP_X: tilePixel += TILE_SIZE * (tileY & 0xF) + 0xF - (tileX & 0xF); break;
-                    case FLIP_Y: tilePixel += (tileX & 0xF) + SCREEN_YSIZE - TILE_SIZE * (tileY & 0xF); break;
-                    case FLIP_XY: tilePixel += 0xF - (tileX & 0xF) + SCREEN_YSIZE - TILE_SIZE * (tileY & 0xF); break;
-                    default: break;
-                }
-
-                if (*tilePixel > 0)
-                    *bufferPtr = activePalette[*tilePixel];
+                byte index = GetMode7Pixel(&tile, (YPos >> 16 << 8) + (XPos >> 16), tileX, tileY);
+                if (index > 0)
+                    *bufferPtr = linePalette[index];
                 else if (drawStageGFXHQ)
                     *bufferPtr = *frameBufferPtr;
             }
@@ -2692,17 +4657,44 @@ void Draw3DSkyLayer(int layerID)
             XPos += xBuffer;
             YPos += yBuffer;
         }
+    }
+}
+#endif
+
+void Draw3DFloorLayer(int layerID)
+{
+    TileLayer *layer = &stageLayouts[activeTileLayers[layerID]];
+    if (!layer->xsize || !layer->ysize)
+        return;
 
-        if (!(i & 1))
-            frameBufferPtr -= GFX_LINESIZE;
+#if RETRO_SOFTWARE_RENDER
+#if !RETRO_USE_ORIGINAL_CODE
+    RunRenderBands(Draw3DFloorBand, &layerID, 108);
+#else
+    Draw3DFloorBand(&layerID, 0, 0, 108);
+#endif
+    activePalette   = fullPalette[gfxLineBuffer[(SCREEN_YSIZE / 2) + 12 + 53]];
+    activePalette32 = fullPalette32[gfxLineBuffer[(SCREEN_YSIZE / 2) + 12 + 53]];
+#endif
+}
+void Draw3DSkyLayer(int layerID)
+{
+    TileLayer *layer = &stageLayouts[activeTileLayers[layerID]];
+    if (!layer->xsize || !layer->ysize)
+        return;
 
-        if (!(i & 1) && !drawStageGFXHQ)
-            bufferPtr -= GFX_LINESIZE;
-    }
+#if RETRO_SOFTWARE_RENDER
+#if !RETRO_USE_ORIGINAL_CODE
+    RunRenderBands(Draw3DSkyBand, &layerID, (SCREEN_YSIZE - TILE_SIZE - TILE_SIZE / 2) / 2);
+#else
+    Draw3DSkyBand(&layerID, 0, 0, (SCREEN_YSIZE - TILE_SIZE - TILE_SIZE / 2) / 2);
+#endif
+    activePalette   = fullPalette[gfxLineBuffer[SCREEN_YSIZE - 1]];
+    activePalette32 = fullPalette32[gfxLineBuffer[SCREEN_YSIZE - 1]];
 
     if (drawStageGFXHQ) {
-        frameBufferPtr = &Engine.frameBuffer[((SCREEN_YSIZE / 2) + 12) * GFX_LINESIZE];
-        int cnt        = ((SCREEN_YSIZE / 2) - 12) * GFX_LINESIZE;
+        ushort *frameBufferPtr = &Engine.frameBuffer[((SCREEN_YSIZE / 2) + 12) * GFX_LINESIZE];
+        int cnt                = ((SCREEN_YSIZE / 2) - 12) * GFX_LINESIZE;
         while (cnt--) *frameBufferPtr++ = 0xF81F; // Magenta
     }
 #endif
@@ -2869,6 +4861,13 @@ void DrawRectangle(int XPos, int YPos, int width, int height, int R, int G, int
         }
     }
     else {
+#if !RETRO_USE_ORIGINAL_CODE
+        int h = height;
+        while (h--) {
+            blendKernels.alphaFill(frameBufferPtr, width, clr, A);
+            frameBufferPtr += GFX_LINESIZE;
+        }
+#else
         ushort *fbufferBlend = &blendLookupTable[0x20 * (0xFF - A)];
         ushort *pixelBlend   = &blendLookupTable[0x20 * A];
 
@@ -2885,6 +4884,7 @@ void DrawRectangle(int XPos, int YPos, int width, int height, int R, int G, int
             }
             frameBufferPtr += pitch;
         }
+#endif
     }
 #endif
 }
@@ -2910,6 +4910,9 @@ void SetFadeHQ(int R, int G, int B, int A)
         }
     }
     else {
+#if !RETRO_USE_ORIGINAL_CODE
+        blendKernels.alphaFill(frameBufferPtr, pitch * SCREEN_YSIZE, clr, A);
+#else
         ushort *fbufferBlend = &blendLookupTable[0x20 * (0xFF - A)];
         ushort *pixelBlend   = &blendLookupTable[0x20 * A];
 
@@ -2925,6 +4928,7 @@ void SetFadeHQ(int R, int G, int B, int A)
                 ++frameBufferPtr;
             }
         }
+#endif
     }
 #endif
 }
@@ -2953,11 +4957,16 @@ void DrawTintRectangle(int XPos, int YPos, int width, int height)
         height--;
         if (height < 0)
             break;
+#if !RETRO_USE_ORIGINAL_CODE
+        blendKernels.tint(frameBufferPtr, width);
+        frameBufferPtr += width;
+#else
         int w = width;
         while (w--) {
             *frameBufferPtr = tintLookupTable[*frameBufferPtr];
             ++frameBufferPtr;
         }
+#endif
     }
 #endif
 }
@@ -3061,6 +5070,189 @@ void DrawScaledTintMask(int direction, int XPos, int YPos, int pivotX, int pivot
 #endif
 }
 
+#if !RETRO_USE_ORIGINAL_CODE
+// makes sure graphicData covers everything before dataEnd, growing it if needed
+bool ReserveGraphicData(int dataEnd)
+{
+    if (dataEnd < 0 || dataEnd > GFXDATA_SIZE)
+        return false;
+
+    if (dataEnd > gfxDataCapacity) {
+        // grow by at least half again so a stage's worth of sheets only moves it a few times
+        int capacity = gfxDataCapacity + gfxDataCapacity / 2;
+        if (capacity < dataEnd)
+            capacity = dataEnd;
+        capacity = (capacity + GFXDATA_GRANULARITY - 1) & ~(GFXDATA_GRANULARITY - 1);
+        if (capacity > GFXDATA_SIZE)
+            capacity = GFXDATA_SIZE;
+
+        byte *data = (byte *)realloc(graphicData, capacity);
+        if (!data) {
+            PrintLog("WARNING: Couldn't grow gfx data to %d bytes!", capacity);
+            return false;
+        }
+        graphicData     = data;
+        gfxDataCapacity = capacity;
+        PrintLog("Gfx data: grown to %d KB", capacity / 1024);
+    }
+
+    // nothing past the high-water mark has been written yet, it's cleared as it's handed out so it reads the same as the old static array did
+    if (dataEnd > gfxDataHighWater) {
+        memset(&graphicData[gfxDataHighWater], 0, dataEnd - gfxDataHighWater);
+        gfxDataHighWater = dataEnd;
+    }
+    return true;
+}
+
+void ReleaseGraphicData()
+{
+    if (graphicData)
+        PrintLog("Gfx data: %d KB high-water mark, %d KB reserved", gfxDataHighWater / 1024, gfxDataCapacity / 1024);
+
+    free(graphicData);
+    graphicData      = NULL;
+    gfxDataCapacity  = 0;
+    gfxDataHighWater = 0;
+}
+
+SurfaceSpans surfaceSpans[SURFACE_COUNT];
+
+void ReleaseSurfaceSpans(int sheetID)
+{
+    SurfaceSpans *spans = &surfaceSpans[sheetID];
+    if (spans->visitedPixels > 0) {
+        PrintLog("Sprite spans: '%s' drew %lld of %lld pixels (%.1f%% skipped)", gfxSurface[sheetID].fileName, spans->drawnPixels,
+                 spans->visitedPixels, 100.0 - spans->drawnPixels * 100.0 / spans->visitedPixels);
+    }
+
+    delete[] spans->rowSpans;
+    delete[] spans->spans;
+    MEM_ZERO(*spans);
+}
+
+void BuildSurfaceSpans(int sheetID)
+{
+    ReleaseSurfaceSpans(sheetID);
+
+#if RETRO_SOFTWARE_RENDER
+    GFXSurface *surface = &gfxSurface[sheetID];
+    int pixelCount      = surface->width * surface->height;
+    if (!Engine.useSpriteSpans || pixelCount <= 0 || surface->width > 0xFFFF || surface->dataPosition + pixelCount > gfxDataCapacity)
+        return;
+
+    byte *gfxData   = &graphicData[surface->dataPosition];
+    int spanCount   = 0;
+    int opaqueCount = 0;
+    for (int y = 0; y < surface->height; ++y) {
+        for (int x = 0; x < surface->width; ++x) {
+            if (gfxData[x] > 0) {
+                ++opaqueCount;
+                if (!x || !gfxData[x - 1])
+                    ++spanCount;
+            }
+        }
+        gfxData += surface->width;
+    }
+
+    // mostly solid or speckled sheets are faster to draw by testing each pixel
+    if (!spanCount || opaqueCount / spanCount < SPRITESPAN_MIN_RUN || opaqueCount > pixelCount / 4 * 3) {
+        PrintLog("Sprite spans: '%s' left raw (%d spans, %.1f%% transparent)", surface->fileName, spanCount,
+                 100.0 - opaqueCount * 100.0 / pixelCount);
+        return;
+    }
+
+    SurfaceSpans *spans = &surfaceSpans[sheetID];
+    spans->rowSpans     = new int[surface->height + 1];
+    spans->spans        = new SpriteSpan[spanCount];
+    spans->spanCount    = spanCount;
+
+    gfxData          = &graphicData[surface->dataPosition];
+    SpriteSpan *span = spans->spans;
+    for (int y = 0; y < surface->height; ++y) {
+        spans->rowSpans[y] = (int)(span - spans->spans);
+        for (int x = 0; x < surface->width;) {
+            if (!gfxData[x]) {
+                ++x;
+                continue;
+            }
+
+            span->start = x;
+            while (x < surface->width && gfxData[x] > 0) ++x;
+            span->end = x;
+            ++span;
+        }
+        gfxData += surface->width;
+    }
+    spans->rowSpans[surface->height] = spanCount;
+
+    int spanSize = (surface->height + 1) * sizeof(int) + spanCount * sizeof(SpriteSpan);
+    PrintLog("Sprite spans: '%s' %d spans, %.1f%% transparent, %d bytes (%.1f%% of the raw sheet)", surface->fileName, spanCount,
+             100.0 - opaqueCount * 100.0 / pixelCount, spanSize, spanSize * 100.0 / pixelCount);
+#endif
+}
+
+#if RETRO_SOFTWARE_RENDER
+// The spans to draw a sprite from, or NULL if it has to use the raw pixels
+// (rects that leave the sheet read into the neighbouring rows, which the spans can't follow)
+inline SurfaceSpans *GetSurfaceSpans(int sheetID, int sprX, int sprY, int width, int height)
+{
+    SurfaceSpans *spans = &surfaceSpans[sheetID];
+    GFXSurface *surface = &gfxSurface[sheetID];
+    if (!Engine.useSpriteSpans || !spans->spans || width < SPRITESPAN_MIN_WIDTH)
+        return NULL;
+    if (sprX < 0 || sprY < 0 || sprX + width > surface->width || sprY + height > surface->height)
+        return NULL;
+    return spans;
+}
+
+// Steps through the opaque runs of a sheet row that fall inside [x, x + width)
+struct SpriteRuns {
+    SpriteSpan *span;
+    SpriteSpan *end;
+    int x;
+    int width;
+};
+
+inline void GetSpriteRuns(SpriteRuns *runs, SurfaceSpans *spans, int row, int x, int width)
+{
+    SpriteSpan *span = &spans->spans[spans->rowSpans[row]];
+    int count        = spans->rowSpans[row + 1] - spans->rowSpans[row];
+    runs->end        = span + count;
+    runs->x          = x;
+    runs->width      = width;
+
+    // find the first span that ends past x
+    while (count > 0) {
+        int half = count >> 1;
+        if (span[half].end <= x) {
+            span += half + 1;
+            count -= half + 1;
+        }
+        else {
+            count = half;
+        }
+    }
+    runs->span = span;
+    spans->visitedPixels += width;
+}
+
+// Gets the next run as an offset from x, returning false once the row is done
+inline bool NextSpriteRun(SpriteRuns *runs, SurfaceSpans *spans, int *offset, int *count)
+{
+    if (runs->span >= runs->end || runs->span->start >= runs->x + runs->width)
+        return false;
+
+    int start = runs->span->start > runs->x ? runs->span->start : runs->x;
+    int end   = runs->span->end < runs->x + runs->width ? runs->span->end : runs->x + runs->width;
+    *offset   = start - runs->x;
+    *count    = end - start;
+    spans->drawnPixels += *count;
+    ++runs->span;
+    return true;
+}
+#endif
+#endif
+
 void DrawSprite(int XPos, int YPos, int width, int height, int sprX, int sprY, int sheetID)
 {
 #if RETRO_SOFTWARE_RENDER
@@ -3087,6 +5279,26 @@ void DrawSprite(int XPos, int YPos, int width, int height, int sprX, int sprY, i
     byte *lineBuffer       = &gfxLineBuffer[YPos];
     byte *gfxDataPtr       = &graphicData[sprX + surface->width * sprY + surface->dataPosition];
     ushort *frameBufferPtr = &Engine.frameBuffer[XPos + GFX_LINESIZE * YPos];
+#if !RETRO_USE_ORIGINAL_CODE
+    SurfaceSpans *spans = GetSurfaceSpans(sheetID, sprX, sprY, width, height);
+    if (spans) {
+        for (int y = 0; y < height; ++y) {
+            activePalette   = fullPalette[*lineBuffer];
+            activePalette32 = fullPalette32[*lineBuffer];
+            lineBuffer++;
+
+            SpriteRuns runs;
+            int offset = 0, count = 0;
+            GetSpriteRuns(&runs, spans, sprY + y, sprX, width);
+            while (NextSpriteRun(&runs, spans, &offset, &count)) {
+                for (int x = offset; x < offset + count; ++x) frameBufferPtr[x] = activePalette[gfxDataPtr[x]];
+            }
+            frameBufferPtr += GFX_LINESIZE;
+            gfxDataPtr += surface->width;
+        }
+        return;
+    }
+#endif
     while (height--) {
         activePalette   = fullPalette[*lineBuffer];
         activePalette32 = fullPalette32[*lineBuffer];
@@ -3175,6 +5387,38 @@ void DrawSpriteFlipped(int XPos, int YPos, int width, int height, int sprX, int
         return;
 
     GFXSurface *surface = &gfxSurface[sheetID];
+#if !RETRO_USE_ORIGINAL_CODE
+    // the sheet rect being drawn, whichever way round it is
+    int spanX           = (direction & FLIP_X) ? sprX + widthFlip - width : sprX;
+    int spanY           = (direction & FLIP_Y) ? sprY + heightFlip - height : sprY;
+    SurfaceSpans *spans = direction <= FLIP_XY ? GetSurfaceSpans(sheetID, spanX, spanY, width, height) : NULL;
+    if (spans) {
+        byte *lineBuffer       = &gfxLineBuffer[YPos];
+        ushort *frameBufferPtr = &Engine.frameBuffer[XPos + GFX_LINESIZE * YPos];
+        for (int y = 0; y < height; ++y) {
+            activePalette   = fullPalette[*lineBuffer];
+            activePalette32 = fullPalette32[*lineBuffer];
+            lineBuffer++;
+
+            int row       = (direction & FLIP_Y) ? spanY + height - 1 - y : spanY + y;
+            byte *gfxData = &graphicData[spanX + surface->width * row + surface->dataPosition];
+            SpriteRuns runs;
+            int offset = 0, count = 0;
+            GetSpriteRuns(&runs, spans, row, spanX, width);
+            while (NextSpriteRun(&runs, spans, &offset, &count)) {
+                if (direction & FLIP_X) {
+                    ushort *pixelPtr = &frameBufferPtr[width - 1 - offset];
+                    for (int x = offset; x < offset + count; ++x) *pixelPtr-- = activePalette[gfxData[x]];
+                }
+                else {
+                    for (int x = offset; x < offset + count; ++x) frameBufferPtr[x] = activePalette[gfxData[x]];
+                }
+            }
+            frameBufferPtr += GFX_LINESIZE;
+        }
+        return;
+    }
+#endif
     int pitch;
     int gfxPitch;
     byte *lineBuffer;
@@ -3384,6 +5628,31 @@ void DrawScaledChar(int direction, int XPos, int YPos, int pivotX, int pivotY, i
 #endif
 }
 #endif
+// Narrows [*start, *end) down to the steps where pos + step * i stays within [min, max], matching a per-pixel bounds check exactly
+inline void ClipSpriteSpan(int pos, int step, int min, int max, int *start, int *end)
+{
+    int first = 0;
+    int last  = 0;
+    if (step > 0) {
+        first = CeilDivide(min - pos, step);
+        last  = FloorDivide(max - pos, step);
+    }
+    else if (step < 0) {
+        first = CeilDivide(max - pos, step);
+        last  = FloorDivide(min - pos, step);
+    }
+    else {
+        if (pos < min || pos > max)
+            *end = *start;
+        return;
+    }
+
+    if (first > *start)
+        *start = first;
+    if (last + 1 < *end)
+        *end = last + 1;
+}
+
 void DrawSpriteRotated(int direction, int XPos, int YPos, int pivotX, int pivotY, int sprX, int sprY, int width, int height, int rotation,
                        int sheetID)
 {
@@ -3465,7 +5734,6 @@ void DrawSpriteRotated(int direction, int XPos, int YPos, int pivotX, int pivotY
         return;
 
     GFXSurface *surface    = &gfxSurface[sheetID];
-    int pitch              = GFX_LINESIZE - maxX;
     int lineSize           = surface->widthShift;
     ushort *frameBufferPtr = &Engine.frameBuffer[left + GFX_LINESIZE * top];
     byte *lineBuffer       = &gfxLineBuffer[top];
@@ -3486,22 +5754,25 @@ void DrawSpriteRotated(int direction, int XPos, int YPos, int pivotX, int pivotY
             activePalette   = fullPalette[*lineBuffer];
             activePalette32 = fullPalette32[*lineBuffer];
             lineBuffer++;
-            int finalX = drawX;
-            int finalY = drawY;
-            int w      = maxX;
-            while (w--) {
-                if (finalX > shiftPivot && finalX < fullwidth && finalY > shiftheight && finalY < fullheight) {
-                    byte index = gfxData[(finalY >> 9 << lineSize) + (finalX >> 9)];
-                    if (index > 0)
-                        *frameBufferPtr = activePalette[index];
-                }
-                ++frameBufferPtr;
+            int start = 0;
+            int end   = maxX;
+            ClipSpriteSpan(drawX, -cosine, shiftPivot + 1, fullwidth - 1, &start, &end);
+            ClipSpriteSpan(drawY, sine, shiftheight + 1, fullheight - 1, &start, &end);
+
+            int finalX       = drawX - cosine * start;
+            int finalY       = drawY + sine * start;
+            ushort *pixelPtr = &frameBufferPtr[start];
+            for (int w = start; w < end; ++w) {
+                byte index = gfxData[(finalY >> 9 << lineSize) + (finalX >> 9)];
+                if (index > 0)
+                    *pixelPtr = activePalette[index];
+                ++pixelPtr;
                 finalX -= cosine;
                 finalY += sine;
             }
             drawX += sine;
             drawY += cosine;
-            frameBufferPtr += pitch;
+            frameBufferPtr += GFX_LINESIZE;
         }
     }
     else {
@@ -3511,22 +5782,25 @@ void DrawSpriteRotated(int direction, int XPos, int YPos, int pivotX, int pivotY
             activePalette   = fullPalette[*lineBuffer];
             activePalette32 = fullPalette32[*lineBuffer];
             lineBuffer++;
-            int finalX = drawX;
-            int finalY = drawY;
-            int w      = maxX;
-            while (w--) {
-                if (finalX > shiftPivot && finalX < fullwidth && finalY > shiftheight && finalY < fullheight) {
-                    byte index = gfxData[(finalY >> 9 << lineSize) + (finalX >> 9)];
-                    if (index > 0)
-                        *frameBufferPtr = activePalette[index];
-                }
-                ++frameBufferPtr;
+            int start = 0;
+            int end   = maxX;
+            ClipSpriteSpan(drawX, cosine, shiftPivot + 1, fullwidth - 1, &start, &end);
+            ClipSpriteSpan(drawY, sine, shiftheight + 1, fullheight - 1, &start, &end);
+
+            int finalX       = drawX + cosine * start;
+            int finalY       = drawY + sine * start;
+            ushort *pixelPtr = &frameBufferPtr[start];
+            for (int w = start; w < end; ++w) {
+                byte index = gfxData[(finalY >> 9 << lineSize) + (finalX >> 9)];
+                if (index > 0)
+                    *pixelPtr = activePalette[index];
+                ++pixelPtr;
                 finalX += cosine;
                 finalY += sine;
             }
             drawX -= sine;
             drawY += cosine;
-            frameBufferPtr += pitch;
+            frameBufferPtr += GFX_LINESIZE;
         }
     }
 #endif
@@ -3619,7 +5893,6 @@ void DrawSpriteRotozoom(int direction, int XPos, int YPos, int pivotX, int pivot
         return;
 
     GFXSurface *surface    = &gfxSurface[sheetID];
-    int pitch              = GFX_LINESIZE - maxX;
     int lineSize           = surface->widthShift;
     ushort *frameBufferPtr = &Engine.frameBuffer[left + GFX_LINESIZE * top];
     byte *lineBuffer       = &gfxLineBuffer[top];
@@ -3640,22 +5913,25 @@ void DrawSpriteRotozoom(int direction, int XPos, int YPos, int pivotX, int pivot
             activePalette   = fullPalette[*lineBuffer];
             activePalette32 = fullPalette32[*lineBuffer];
             lineBuffer++;
-            int finalX = drawX;
-            int finalY = drawY;
-            int w      = maxX;
-            while (w--) {
-                if (finalX > shiftPivot && finalX < fullwidth && finalY > shiftheight && finalY < fullheight) {
-                    byte index = gfxData[(finalY >> 9 << lineSize) + (finalX >> 9)];
-                    if (index > 0)
-                        *frameBufferPtr = activePalette[index];
-                }
-                ++frameBufferPtr;
+            int start = 0;
+            int end   = maxX;
+            ClipSpriteSpan(drawX, -cosine, shiftPivot + 1, fullwidth - 1, &start, &end);
+            ClipSpriteSpan(drawY, sine, shiftheight + 1, fullheight - 1, &start, &end);
+
+            int finalX       = drawX - cosine * start;
+            int finalY       = drawY + sine * start;
+            ushort *pixelPtr = &frameBufferPtr[start];
+            for (int w = start; w < end; ++w) {
+                byte index = gfxData[(finalY >> 9 << lineSize) + (finalX >> 9)];
+                if (index > 0)
+                    *pixelPtr = activePalette[index];
+                ++pixelPtr;
                 finalX -= cosine;
                 finalY += sine;
             }
             drawX += sine;
             drawY += cosine;
-            frameBufferPtr += pitch;
+            frameBufferPtr += GFX_LINESIZE;
         }
     }
     else {
@@ -3665,22 +5941,25 @@ void DrawSpriteRotozoom(int direction, int XPos, int YPos, int pivotX, int pivot
             activePalette   = fullPalette[*lineBuffer];
             activePalette32 = fullPalette32[*lineBuffer];
             lineBuffer++;
-            int finalX = drawX;
-            int finalY = drawY;
-            int w      = maxX;
-            while (w--) {
-                if (finalX > shiftPivot && finalX < fullwidth && finalY > shiftheight && finalY < fullheight) {
-                    byte index = gfxData[(finalY >> 9 << lineSize) + (finalX >> 9)];
-                    if (index > 0)
-                        *frameBufferPtr = activePalette[index];
-                }
-                ++frameBufferPtr;
+            int start = 0;
+            int end   = maxX;
+            ClipSpriteSpan(drawX, cosine, shiftPivot + 1, fullwidth - 1, &start, &end);
+            ClipSpriteSpan(drawY, sine, shiftheight + 1, fullheight - 1, &start, &end);
+
+            int finalX       = drawX + cosine * start;
+            int finalY       = drawY + sine * start;
+            ushort *pixelPtr = &frameBufferPtr[start];
+            for (int w = start; w < end; ++w) {
+                byte index = gfxData[(finalY >> 9 << lineSize) + (finalX >> 9)];
+                if (index > 0)
+                    *pixelPtr = activePalette[index];
+                ++pixelPtr;
                 finalX += cosine;
                 finalY += sine;
             }
             drawX -= sine;
             drawY += cosine;
-            frameBufferPtr += pitch;
+            frameBufferPtr += GFX_LINESIZE;
         }
     }
 #endif
@@ -4203,6 +6482,27 @@ void DrawBlendedSprite(int XPos, int YPos, int width, int height, int sprX, int
     byte *lineBuffer       = &gfxLineBuffer[YPos];
     byte *gfxData          = &graphicData[sprX + surface->width * sprY + surface->dataPosition];
     ushort *frameBufferPtr = &Engine.frameBuffer[XPos + GFX_LINESIZE * YPos];
+#if !RETRO_USE_ORIGINAL_CODE
+    SurfaceSpans *spans = GetSurfaceSpans(sheetID, sprX, sprY, width, height);
+    if (spans) {
+        for (int y = 0; y < height; ++y) {
+            activePalette   = fullPalette[*lineBuffer];
+            activePalette32 = fullPalette32[*lineBuffer];
+            lineBuffer++;
+
+            SpriteRuns runs;
+            int offset = 0, count = 0;
+            GetSpriteRuns(&runs, spans, sprY + y, sprX, width);
+            while (NextSpriteRun(&runs, spans, &offset, &count)) {
+            for (int x = offset; x < offset + count; ++x)
+                frameBufferPtr[x] = ((activePalette[gfxData[x]] & 0xF7DE) >> 1) + ((frameBufferPtr[x] & 0xF7DE) >> 1);
+            }
+            frameBufferPtr += GFX_LINESIZE;
+            gfxData += surface->width;
+        }
+        return;
+    }
+#endif
     while (height--) {
         activePalette   = fullPalette[*lineBuffer];
         activePalette32 = fullPalette32[*lineBuffer];
@@ -4247,6 +6547,31 @@ void DrawAlphaBlendedSprite(int XPos, int YPos, int width, int height, int sprX,
     byte *lineBuffer       = &gfxLineBuffer[YPos];
     byte *gfxData          = &graphicData[sprX + surface->width * sprY + surface->dataPosition];
     ushort *frameBufferPtr = &Engine.frameBuffer[XPos + GFX_LINESIZE * YPos];
+#if !RETRO_USE_ORIGINAL_CODE
+    SurfaceSpans *spans = GetSurfaceSpans(sheetID, sprX, sprY, width, height);
+    if (spans) {
+        for (int y = 0; y < height; ++y) {
+            activePalette   = fullPalette[*lineBuffer];
+            activePalette32 = fullPalette32[*lineBuffer];
+            lineBuffer++;
+
+            SpriteRuns runs;
+            int offset = 0, count = 0;
+            GetSpriteRuns(&runs, spans, sprY + y, sprX, width);
+            while (NextSpriteRun(&runs, spans, &offset, &count)) {
+            if (alpha == 0xFF) {
+                for (int x = offset; x < offset + count; ++x) frameBufferPtr[x] = activePalette[gfxData[x]];
+            }
+            else {
+                blendKernels.alphaSprite(&frameBufferPtr[offset], &gfxData[offset], activePalette, count, alpha);
+            }
+            }
+            frameBufferPtr += GFX_LINESIZE;
+            gfxData += surface->width;
+        }
+        return;
+    }
+#endif
     if (alpha == 0xFF) {
         while (height--) {
             activePalette   = fullPalette[*lineBuffer];
@@ -4264,6 +6589,16 @@ void DrawAlphaBlendedSprite(int XPos, int YPos, int width, int height, int sprX,
         }
     }
     else {
+#if !RETRO_USE_ORIGINAL_CODE
+        while (height--) {
+            activePalette   = fullPalette[*lineBuffer];
+            activePalette32 = fullPalette32[*lineBuffer];
+            lineBuffer++;
+            blendKernels.alphaSprite(frameBufferPtr, gfxData, activePalette, width, alpha);
+            frameBufferPtr += GFX_LINESIZE;
+            gfxData += surface->width;
+        }
+#else
 		//Commented out - we're calculating it live
         //ushort *fbufferBlend = &blendLookupTable[0x20 * (0xFF - alpha)];
         //ushort *pixelBlend   = &blendLookupTable[0x20 * alpha];
@@ -4293,6 +6628,7 @@ void DrawAlphaBlendedSprite(int XPos, int YPos, int width, int height, int sprX,
             frameBufferPtr += pitch;
             gfxData += gfxPitch;
         }
+#endif
     }
 #endif
 }
@@ -4318,16 +6654,43 @@ void DrawAdditiveBlendedSprite(int XPos, int YPos, int width, int height, int sp
     if (width <= 0 || height <= 0 || alpha <= 0)
         return;
 
-   
-	//Commented out - we're calculating it live
-    //ushort *pixelBlend  = &blendLookupTable[0x20 * alpha];
     GFXSurface *surface    = &gfxSurface[sheetID];
-    int pitch              = GFX_LINESIZE - width;
-    int gfxPitch           = surface->width - width;
     byte *lineBuffer       = &gfxLineBuffer[YPos];
     byte *gfxData          = &graphicData[sprX + surface->width * sprY + surface->dataPosition];
     ushort *frameBufferPtr = &Engine.frameBuffer[XPos + GFX_LINESIZE * YPos];
+#if !RETRO_USE_ORIGINAL_CODE
+    SurfaceSpans *spans = GetSurfaceSpans(sheetID, sprX, sprY, width, height);
+    if (spans) {
+        for (int y = 0; y < height; ++y) {
+            activePalette   = fullPalette[*lineBuffer];
+            activePalette32 = fullPalette32[*lineBuffer];
+            lineBuffer++;
+
+            SpriteRuns runs;
+            int offset = 0, count = 0;
+            GetSpriteRuns(&runs, spans, sprY + y, sprX, width);
+            while (NextSpriteRun(&runs, spans, &offset, &count)) {
+            blendKernels.additiveSprite(&frameBufferPtr[offset], &gfxData[offset], activePalette, count, alpha);
+            }
+            frameBufferPtr += GFX_LINESIZE;
+            gfxData += surface->width;
+        }
+        return;
+    }
+#endif
 
+#if !RETRO_USE_ORIGINAL_CODE
+    while (height--) {
+        activePalette   = fullPalette[*lineBuffer];
+        activePalette32 = fullPalette32[*lineBuffer];
+        lineBuffer++;
+        blendKernels.additiveSprite(frameBufferPtr, gfxData, activePalette, width, alpha);
+        frameBufferPtr += GFX_LINESIZE;
+        gfxData += surface->width;
+    }
+#else
+    int pitch    = GFX_LINESIZE - width;
+    int gfxPitch = surface->width - width;
     while (height--) {
         activePalette   = fullPalette[*lineBuffer];
         activePalette32 = fullPalette32[*lineBuffer];
@@ -4353,6 +6716,7 @@ void DrawAdditiveBlendedSprite(int XPos, int YPos, int width, int height, int sp
         gfxData += gfxPitch;
     }
 #endif
+#endif
 }
 void DrawSubtractiveBlendedSprite(int XPos, int YPos, int width, int height, int sprX, int sprY, int alpha, int sheetID)
 {
@@ -4377,15 +6741,43 @@ void DrawSubtractiveBlendedSprite(int XPos, int YPos, int width, int height, int
     if (width <= 0 || height <= 0 || alpha <= 0)
         return;
 
-    //Commented out - we're calculating it live
-    //ushort *subBlendTable  = &subtractLookupTable[0x20 * alpha];
     GFXSurface *surface    = &gfxSurface[sheetID];
-    int pitch              = GFX_LINESIZE - width;
-    int gfxPitch           = surface->width - width;
     byte *lineBuffer       = &gfxLineBuffer[YPos];
     byte *gfxData          = &graphicData[sprX + surface->width * sprY + surface->dataPosition];
     ushort *frameBufferPtr = &Engine.frameBuffer[XPos + GFX_LINESIZE * YPos];
+#if !RETRO_USE_ORIGINAL_CODE
+    SurfaceSpans *spans = GetSurfaceSpans(sheetID, sprX, sprY, width, height);
+    if (spans) {
+        for (int y = 0; y < height; ++y) {
+            activePalette   = fullPalette[*lineBuffer];
+            activePalette32 = fullPalette32[*lineBuffer];
+            lineBuffer++;
+
+            SpriteRuns runs;
+            int offset = 0, count = 0;
+            GetSpriteRuns(&runs, spans, sprY + y, sprX, width);
+            while (NextSpriteRun(&runs, spans, &offset, &count)) {
+            blendKernels.subtractiveSprite(&frameBufferPtr[offset], &gfxData[offset], activePalette, count, alpha);
+            }
+            frameBufferPtr += GFX_LINESIZE;
+            gfxData += surface->width;
+        }
+        return;
+    }
+#endif
 
+#if !RETRO_USE_ORIGINAL_CODE
+    while (height--) {
+        activePalette   = fullPalette[*lineBuffer];
+        activePalette32 = fullPalette32[*lineBuffer];
+        lineBuffer++;
+        blendKernels.subtractiveSprite(frameBufferPtr, gfxData, activePalette, width, alpha);
+        frameBufferPtr += GFX_LINESIZE;
+        gfxData += surface->width;
+    }
+#else
+    int pitch    = GFX_LINESIZE - width;
+    int gfxPitch = surface->width - width;
     while (height--) {
         activePalette   = fullPalette[*lineBuffer];
         activePalette32 = fullPalette32[*lineBuffer];
@@ -4411,6 +6803,7 @@ void DrawSubtractiveBlendedSprite(int XPos, int YPos, int width, int height, int
         gfxData += gfxPitch;
     }
 #endif
+#endif
 }
 
 void DrawObjectAnimation(void *objScr, void *ent, int XPos, int YPos)
@@ -4514,6 +6907,184 @@ void DrawObjectAnimation(void *objScr, void *ent, int XPos, int YPos)
     }
 }
 
+#if RETRO_SOFTWARE_RENDER && !RETRO_USE_ORIGINAL_CODE
+// Sorts a face's corners by height and fills in faceLineStart/End (plus the UVs for textured faces) for the rows it covers.
+// every pair of corners gets scanned rather than just the outline, so the spans come out exactly as they always have
+static void ScanFaceEdges(Vertex *verts, bool textured, int *top, int *bottom)
+{
+    int vertexA = 0;
+    int vertexB = 1;
+    int vertexC = 2;
+    int vertexD = 3;
+    if (verts[1].y < verts[0].y) {
+        vertexA = 1;
+        vertexB = 0;
+    }
+    if (verts[2].y < verts[vertexA].y) {
+        int temp = vertexA;
+        vertexA  = 2;
+        vertexC  = temp;
+    }
+    if (verts[3].y < verts[vertexA].y) {
+        int temp = vertexA;
+        vertexA  = 3;
+        vertexD  = temp;
+    }
+    if (verts[vertexC].y < verts[vertexB].y) {
+        int temp = vertexB;
+        vertexB  = vertexC;
+        vertexC  = temp;
+    }
+    if (verts[vertexD].y < verts[vertexB].y) {
+        int temp = vertexB;
+        vertexB  = vertexD;
+        vertexD  = temp;
+    }
+    if (verts[vertexD].y < verts[vertexC].y) {
+        int temp = vertexC;
+        vertexC  = vertexD;
+        vertexD  = temp;
+    }
+
+    int faceTop    = verts[vertexA].y;
+    int faceBottom = verts[vertexD].y;
+    if (faceTop < 0)
+        faceTop = 0;
+    if (faceBottom > SCREEN_YSIZE)
+        faceBottom = SCREEN_YSIZE;
+    for (int i = faceTop; i < faceBottom; ++i) {
+        faceLineStart[i] = 100000;
+        faceLineEnd[i]   = -100000;
+    }
+
+    if (textured) {
+        ProcessScanEdgeUV(&verts[vertexA], &verts[vertexB]);
+        ProcessScanEdgeUV(&verts[vertexA], &verts[vertexC]);
+        ProcessScanEdgeUV(&verts[vertexA], &verts[vertexD]);
+        ProcessScanEdgeUV(&verts[vertexB], &verts[vertexC]);
+        ProcessScanEdgeUV(&verts[vertexC], &verts[vertexD]);
+        ProcessScanEdgeUV(&verts[vertexB], &verts[vertexD]);
+    }
+    else {
+        ProcessScanEdge(&verts[vertexA], &verts[vertexB]);
+        ProcessScanEdge(&verts[vertexA], &verts[vertexC]);
+        ProcessScanEdge(&verts[vertexA], &verts[vertexD]);
+        ProcessScanEdge(&verts[vertexB], &verts[vertexC]);
+        ProcessScanEdge(&verts[vertexC], &verts[vertexD]);
+        ProcessScanEdge(&verts[vertexB], &verts[vertexD]);
+    }
+
+    *top    = faceTop;
+    *bottom = faceBottom;
+}
+
+// one row of a textured face. the UVs are 16.16 and clamp to 0 for good once they go below it, so the clamps can only be
+// skipped when neither one goes negative anywhere on the row
+static inline void DrawTexturedFaceSpan(ushort *fbPtr, const byte *sheetPtr, int shiftwidth, int UPos, int VPos, int deltaU, int deltaV, int count,
+                                        bool blended)
+{
+    if (count <= 0)
+        return;
+
+    long long lastU = UPos + (long long)deltaU * (count - 1);
+    long long lastV = VPos + (long long)deltaV * (count - 1);
+    if (UPos >= 0 && VPos >= 0 && lastU >= 0 && lastV >= 0) {
+        // fetch a run of texels first, then draw them like a sprite row so the keying & blending can go through the span kernels
+        byte texels[0x40];
+        while (count > 0) {
+            int runLength = count < 0x40 ? count : 0x40;
+            if (!deltaV) {
+                // rows of floors & billboards often keep the same texel row the whole way across
+                const byte *rowPtr = &sheetPtr[VPos >> 16 << shiftwidth];
+                for (int i = 0; i < runLength; ++i, UPos += deltaU) texels[i] = rowPtr[UPos >> 16];
+            }
+            else {
+                for (int i = 0; i < runLength; ++i, UPos += deltaU, VPos += deltaV) texels[i] = sheetPtr[(VPos >> 16 << shiftwidth) + (UPos >> 16)];
+            }
+
+            if (blended)
+                blendKernels.halfBlendSprite(fbPtr, texels, activePalette, runLength);
+            else
+                blendKernels.paletteSprite(fbPtr, texels, activePalette, runLength);
+            fbPtr += runLength;
+            count -= runLength;
+        }
+        return;
+    }
+
+    while (count--) {
+        if (UPos < 0)
+            UPos = 0;
+        if (VPos < 0)
+            VPos = 0;
+        byte index = sheetPtr[(VPos >> 16 << shiftwidth) + (UPos >> 16)];
+        if (index > 0)
+            *fbPtr = blended ? ((activePalette[index] & 0xF7BC) >> 1) + ((*fbPtr & 0xF7BC) >> 1) : activePalette[index];
+        fbPtr++;
+        UPos += deltaU;
+        VPos += deltaV;
+    }
+}
+
+// walks the spans of a textured face, the per row setup (UV steps & clipping the left edge) is the original's
+static void DrawTexturedFaceSpans(int faceTop, int faceBottom, byte sheetID, bool blended)
+{
+    ushort *frameBufferPtr = &Engine.frameBuffer[GFX_LINESIZE * faceTop];
+    byte *sheetPtr         = &graphicData[gfxSurface[sheetID].dataPosition];
+    int shiftwidth         = gfxSurface[sheetID].widthShift;
+    byte *lineBuffer       = &gfxLineBuffer[faceTop];
+    for (; faceTop < faceBottom; ++faceTop, frameBufferPtr += GFX_LINESIZE) {
+        activePalette   = fullPalette[*lineBuffer];
+        activePalette32 = fullPalette32[*lineBuffer];
+        lineBuffer++;
+        int startX = faceLineStart[faceTop];
+        int endX   = faceLineEnd[faceTop];
+        if (startX >= GFX_LINESIZE || endX <= 0)
+            continue;
+
+        int UPos          = faceLineStartU[faceTop];
+        int VPos          = faceLineStartV[faceTop];
+        int posDifference = endX - startX;
+        int bufferedUPos  = 0;
+        int bufferedVPos  = 0;
+        if (endX != startX) {
+            bufferedUPos = (faceLineEndU[faceTop] - UPos) / posDifference;
+            bufferedVPos = (faceLineEndV[faceTop] - VPos) / posDifference;
+        }
+        if (endX > GFX_LINESIZE_MINUSONE)
+            posDifference = GFX_LINESIZE_MINUSONE - startX;
+        if (startX < 0) {
+            posDifference += startX;
+            UPos -= startX * bufferedUPos;
+            VPos -= startX * bufferedVPos;
+            startX = 0;
+        }
+        DrawTexturedFaceSpan(&frameBufferPtr[startX], sheetPtr, shiftwidth, UPos, VPos, bufferedUPos, bufferedVPos, posDifference, blended);
+    }
+}
+
+// walks the spans of a flat face: a solid colour is a plain fill, anything else blends over the frame
+static void DrawFlatFaceSpans(int faceTop, int faceBottom, ushort color16, int alpha)
+{
+    ushort *frameBufferPtr = &Engine.frameBuffer[GFX_LINESIZE * faceTop];
+    for (; faceTop < faceBottom; ++faceTop, frameBufferPtr += GFX_LINESIZE) {
+        int startX = faceLineStart[faceTop];
+        int endX   = faceLineEnd[faceTop];
+        if (startX >= GFX_LINESIZE || endX <= 0)
+            continue;
+
+        if (startX < 0)
+            startX = 0;
+        if (endX > GFX_LINESIZE_MINUSONE)
+            endX = GFX_LINESIZE_MINUSONE;
+        if (alpha == 0xFF)
+            blendKernels.fill(&frameBufferPtr[startX], endX - startX + 1, color16);
+        else
+            blendKernels.alphaFill(&frameBufferPtr[startX], endX - startX + 1, color16, alpha);
+    }
+}
+#endif
+
 void DrawFace(void *v, uint color)
 {
     Vertex *verts = (Vertex *)v;
@@ -4543,6 +7114,13 @@ void DrawFace(void *v, uint color)
         return;
 
 #if RETRO_SOFTWARE_RENDER
+#if !RETRO_USE_ORIGINAL_CODE
+    int faceTop, faceBottom;
+    ScanFaceEdges(verts, false, &faceTop, &faceBottom);
+
+    ushort color16 = PACK_RGB888(((color >> 16) & 0xFF), ((color >> 8) & 0xFF), ((color >> 0) & 0xFF));
+    DrawFlatFaceSpans(faceTop, faceBottom, color16, alpha);
+#else
     int vertexA = 0;
     int vertexB = 1;
     int vertexC = 2;
@@ -4652,6 +7230,7 @@ void DrawFace(void *v, uint color)
         }
     }
 #endif
+#endif
 }
 void DrawFadedFace(void *v, uint color, uint fogColor, int alpha)
 {
@@ -4681,6 +7260,21 @@ void DrawFadedFace(void *v, uint color, uint fogColor, int alpha)
         return;
 
 #if RETRO_SOFTWARE_RENDER
+#if !RETRO_USE_ORIGINAL_CODE
+    int faceTop, faceBottom;
+    ScanFaceEdges(verts, false, &faceTop, &faceBottom);
+
+    // the colour is faded towards the fog rather than blended with the frame, so every pixel of the face is the same
+    ushort color16       = PACK_RGB888(((color >> 16) & 0xFF), ((color >> 8) & 0xFF), ((color >> 0) & 0xFF));
+    ushort fogColor16    = PACK_RGB888(((fogColor >> 16) & 0xFF), ((fogColor >> 8) & 0xFF), ((fogColor >> 0) & 0xFF));
+    ushort *fbufferBlend = &blendLookupTable[0x20 * (0xFF - alpha)];
+    ushort *pixelBlend   = &blendLookupTable[0x20 * alpha];
+
+    int R = (fbufferBlend[(fogColor16 & 0xF800) >> 11] + pixelBlend[(color16 & 0xF800) >> 11]) << 11;
+    int G = (fbufferBlend[(fogColor16 & 0x7E0) >> 6] + pixelBlend[(color16 & 0x7E0) >> 6]) << 6;
+    int B = fbufferBlend[fogColor16 & 0x1F] + pixelBlend[color16 & 0x1F];
+    DrawFlatFaceSpans(faceTop, faceBottom, R | G | B, 0xFF);
+#else
     int vertexA = 0;
     int vertexB = 1;
     int vertexC = 2;
@@ -4766,6 +7360,7 @@ void DrawFadedFace(void *v, uint color, uint fogColor, int alpha)
         ++faceTop;
     }
 #endif
+#endif
 }
 void DrawTexturedFace(void *v, byte sheetID)
 {
@@ -4785,6 +7380,11 @@ void DrawTexturedFace(void *v, byte sheetID)
         return;
 
 #if RETRO_SOFTWARE_RENDER
+#if !RETRO_USE_ORIGINAL_CODE
+    int faceTop, faceBottom;
+    ScanFaceEdges(verts, true, &faceTop, &faceBottom);
+    DrawTexturedFaceSpans(faceTop, faceBottom, sheetID, false);
+#else
     int vertexA = 0;
     int vertexB = 1;
     int vertexC = 2;
@@ -4891,6 +7491,7 @@ void DrawTexturedFace(void *v, byte sheetID)
         ++faceTop;
     }
 #endif
+#endif
 }
 void DrawTexturedFaceBlended(void *v, byte sheetID)
 {
@@ -4914,6 +7515,11 @@ void DrawTexturedFaceBlended(void *v, byte sheetID)
         return;
 
 #if RETRO_SOFTWARE_RENDER
+#if !RETRO_USE_ORIGINAL_CODE
+    int faceTop, faceBottom;
+    ScanFaceEdges(verts, true, &faceTop, &faceBottom);
+    DrawTexturedFaceSpans(faceTop, faceBottom, sheetID, true);
+#else
     int vertexA = 0;
     int vertexB = 1;
     int vertexC = 2;
@@ -5020,6 +7626,7 @@ void DrawTexturedFaceBlended(void *v, byte sheetID)
         ++faceTop;
     }
 #endif
+#endif
 }
 
 #if RETRO_REV00 || RETRO_REV01
@@ -3,9 +3,20 @@
 
 #define SURFACE_COUNT (96)
 #define GFXDATA_SIZE (0x8000 * 0x8000)
+#if !RETRO_USE_ORIGINAL_CODE
+// the gfx data arena grows in whole steps of this
+#define GFXDATA_GRANULARITY (0x100000)
+#endif
 
 #define DRAWLAYER_COUNT (10)
 
+#define RENDERTHREAD_COUNT (8)
+
+// sheets with shorter opaque runs than this on average are drawn from the raw pixels
+#define SPRITESPAN_MIN_RUN   (4)
+// narrower sprites than this are drawn from the raw pixels
+#define SPRITESPAN_MIN_WIDTH (8)
+
 //changing DrawFXFlags so they can be merged with binary
 #define FX_FLIP (1)
 #define FX_ROTATE (2)
@@ -34,6 +45,9 @@ struct GFXSurface {
 #endif
     int depth;
     int dataPosition;
+#if !RETRO_USE_ORIGINAL_CODE
+    uint fileHash;
+#endif
 };
 
 struct DisplaySettings {
@@ -68,7 +82,20 @@ extern DrawListEntry drawListEntries[DRAWLAYER_COUNT];
 
 extern int gfxDataPosition;
 extern GFXSurface gfxSurface[SURFACE_COUNT];
+#if RETRO_USE_ORIGINAL_CODE
 extern byte graphicData[GFXDATA_SIZE];
+#else
+// grows as sheets are loaded rather than reserving the whole GFXDATA_SIZE up front
+// it can move when it grows, so keep indexing it by dataPosition instead of holding pointers across loads
+extern byte *graphicData;
+extern int gfxDataCapacity;
+extern int gfxDataHighWater;
+// every surface below it is in use, AddGraphicsFile walks it forward & anything that frees a surface pulls it back
+extern int firstFreeSurface;
+
+bool ReserveGraphicData(int dataEnd);
+void ReleaseGraphicData();
+#endif
 
 extern DisplaySettings displaySettings;
 extern bool convertTo32Bit;
@@ -87,10 +114,64 @@ void ReleaseRenderDevice(bool refresh = false);
 
 void GenerateBlendLookupTable();
 
+#if !RETRO_USE_ORIGINAL_CODE
+struct BlendKernels {
+    void (*alphaFill)(ushort *frameBufferPtr, int count, ushort colour, int alpha);
+    void (*tint)(ushort *frameBufferPtr, int count);
+    void (*alphaSprite)(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count, int alpha);
+    void (*additiveSprite)(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count, int alpha);
+    void (*subtractiveSprite)(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count, int alpha);
+    void (*fill)(ushort *frameBufferPtr, int count, ushort colour);
+    void (*keyedOverlay2x)(ushort *frameBuffer2x, int pitch, const ushort *frameBufferPtr, int count);
+    void (*paletteSprite)(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count);
+    void (*halfBlendSprite)(ushort *frameBufferPtr, const byte *gfxData, const ushort *palette, int count);
+};
+
+extern BlendKernels blendKernels;
+
+void SetBlendKernels(bool useSIMD);
+void BenchmarkBlendKernels();
+void BenchmarkFrameKernels();
+void BenchmarkScrollLayers();
+void BenchmarkSpriteSpans();
+
+extern int renderThreadCount;
+
+void InitRenderThreads(int count);
+void ReleaseRenderThreads();
+void RunRenderBands(void (*job)(void *data, int band, int startLine, int endLine), void *data, int lineCount);
+
+// Opaque runs of pixels in each row of a surface, so sprites can skip the transparent parts instead of testing every pixel
+struct SpriteSpan {
+    ushort start;
+    ushort end;
+};
+
+struct SurfaceSpans {
+    // index of the first span of each row, with one more entry for the end of the last row
+    int *rowSpans;
+    SpriteSpan *spans;
+    int spanCount;
+    long long visitedPixels;
+    long long drawnPixels;
+};
+
+extern SurfaceSpans surfaceSpans[SURFACE_COUNT];
+
+void BuildSurfaceSpans(int sheetID);
+void ReleaseSurfaceSpans(int sheetID);
+#endif
+
 inline void ClearGraphicsData()
 {
+#if !RETRO_USE_ORIGINAL_CODE
+    for (int i = 0; i < SURFACE_COUNT; ++i) ReleaseSurfaceSpans(i);
+#endif
     for (int i = 0; i < SURFACE_COUNT; ++i) MEM_ZERO(gfxSurface[i]);
     gfxDataPosition = 0;
+#if !RETRO_USE_ORIGINAL_CODE
+    firstFreeSurface = 0;
+#endif
 }
 void ClearScreen(byte index);
 void SetScreenDimensions(int width, int height);
@@ -111,6 +192,33 @@ void DrawDebugOverlays();
 #endif
 
 // TileLayer Drawing
+#if !RETRO_USE_ORIGINAL_CODE
+void ResetTileCache();
+void InvalidateTileCache(int tileID);
+void ReleaseTileCache();
+
+struct LayerOcclusion {
+    bool active;
+    bool failed;
+    // where each HScroll layer's expected to land, for the layers it's covered under it so far this frame
+    bool predicted[4];
+    int lineXPos[4][SCREEN_YSIZE];
+    int lineYPos[4][SCREEN_YSIZE];
+    // one bit per screen pixel, set where a tile layer drawn after the one being drawn is opaque
+    uint *coverage;
+    int lineWords;
+    // only counted while engineDebugMode's on, for the log every 60 frames
+    long long drawnPixels[4];
+    long long skippedPixels[4];
+    int frameCount;
+};
+
+extern LayerOcclusion layerOcclusion;
+
+void PrepareLayerOcclusion();
+void ReleaseLayerOcclusion();
+void SetupHLineScrollLayer(int layerID, int *lineXPos, int *lineYPos);
+#endif
 void DrawHLineScrollLayer(int layerID);
 void DrawVLineScrollLayer(int layerID);
 void Draw3DFloorLayer(int layerID);
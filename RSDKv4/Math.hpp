@@ -66,4 +66,14 @@ byte ArcTanLookup(int X, int Y);
 
 inline double DegreesToRad(float degrees) { return (M_PI / 180) * degrees; }
 
+// Integer division rounded towards negative/positive infinity, rather than towards zero
+inline int FloorDivide(int a, int b)
+{
+    int q = a / b;
+    if ((a % b) && ((a < 0) != (b < 0)))
+        --q;
+    return q;
+}
+inline int CeilDivide(int a, int b) { return -FloorDivide(-a, b); }
+
 #endif // !MATH_H
@@ -26,6 +26,8 @@ int fadeX = 0;
 
 int paletteMode = 1;
 
+uint paletteGeneration[PALETTE_COUNT] = { 1, 1, 1, 1, 1, 1, 1, 1 };
+
 void LoadPalette(const char *filePath, int paletteID, int startPaletteIndex, int startIndex, int endIndex)
 {
     FileInfo info;
@@ -81,6 +83,7 @@ void SetLimitedFade(byte paletteID, byte R, byte G, byte B, ushort alpha, int st
         activePalette32[i].g = (byte)((ushort)(G * alpha + alpha2 * activePalette32[i].g) >> 8);
         activePalette32[i].b = (byte)((ushort)(B * alpha + alpha2 * activePalette32[i].b) >> 8);
     }
+    ++paletteGeneration[paletteID];
 }
 #else
 void SetPaletteFade(byte destPaletteID, byte srcPaletteA, byte srcPaletteB, ushort blendAmount, int startIndex, int endIndex)
@@ -108,5 +111,6 @@ void SetPaletteFade(byte destPaletteID, byte srcPaletteA, byte srcPaletteB, usho
         ++dst;
         ++dst32;
     }
+    ++paletteGeneration[destPaletteID];
 }
 #endif
\ No newline at end of file
@@ -41,6 +41,10 @@ extern int fadeX;
 
 extern int paletteMode;
 
+// bumped whenever a palette's contents change, so anything caching resolved colours knows when to rebuild
+extern uint paletteGeneration[PALETTE_COUNT];
+#define ACTIVE_PALETTE_ID ((int)((activePalette - fullPalette[0]) / PALETTE_COLOR_COUNT))
+
 #define RGB888_TO_RGB5551(r, g, b) (2 * ((b) >> 3) | ((g) >> 3 << 6) | ((r) >> 3 << 11) | 0) // used in mobile vers
 #define RGB888_TO_RGB565(r, g, b)  ((b) >> 3) | (((g) >> 2) << 5) | (((r) >> 3) << 11) // used in pc vers
 
@@ -70,12 +74,14 @@ inline void SetPaletteEntry(byte paletteIndex, byte index, byte r, byte g, byte
         fullPalette32[paletteIndex][index].r = r;
         fullPalette32[paletteIndex][index].g = g;
         fullPalette32[paletteIndex][index].b = b;
+        ++paletteGeneration[paletteIndex];
     }
     else {
         activePalette[index]     = PACK_RGB888(r, g, b);
         activePalette32[index].r = r;
         activePalette32[index].g = g;
         activePalette32[index].b = b;
+        ++paletteGeneration[ACTIVE_PALETTE_ID];
     }
 }
 
@@ -86,6 +92,7 @@ inline void SetPaletteEntryPacked(byte paletteIndex, byte index, uint color)
     fullPalette32[paletteIndex][index].r = (byte)(color >> 16);
     fullPalette32[paletteIndex][index].g = (byte)(color >> 8);
     fullPalette32[paletteIndex][index].b = (byte)(color >> 0);
+    ++paletteGeneration[paletteIndex];
 }
 
 inline uint GetPaletteEntryPacked(byte paletteIndex, byte index)
@@ -101,6 +108,7 @@ inline void CopyPalette(byte sourcePalette, byte srcPaletteStart, byte destinati
             fullPalette[destinationPalette][destPaletteStart + i]   = fullPalette[sourcePalette][srcPaletteStart + i];
             fullPalette32[destinationPalette][destPaletteStart + i] = fullPalette32[sourcePalette][srcPaletteStart + i];
         }
+        ++paletteGeneration[destinationPalette];
     }
 }
 
@@ -126,6 +134,7 @@ inline void RotatePalette(int palID, byte startIndex, byte endIndex, bool right)
         fullPalette[palID][endIndex]   = startClr;
         fullPalette32[palID][endIndex] = startClr32;
     }
+    ++paletteGeneration[palID];
 }
 
 inline void SetFade(byte mode, byte R, byte G, byte B, int A)
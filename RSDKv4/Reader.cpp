@@ -1,6 +1,20 @@
 #include "RetroEngine.hpp"
 #include <string>
 
+#if RETRO_USING_MMAP
+#include <sys/mman.h>
+#endif
+#if RETRO_USING_MMAP || RETRO_USING_PREAD
+#include <unistd.h>
+#endif
+#if !RETRO_USE_ORIGINAL_CODE
+#if RETRO_PLATFORM == RETRO_WIN || RETRO_PLATFORM == RETRO_UWP || RETRO_PLATFORM == RETRO_OSX || RETRO_PLATFORM == RETRO_iOS                        \
+    || RETRO_PLATFORM == RETRO_LINUX || RETRO_PLATFORM == RETRO_ANDROID || RETRO_PLATFORM == RETRO_SWITCH
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+#endif
+
 RSDKContainer rsdkContainer;
 
 char fileName[0x100];
@@ -22,6 +36,196 @@ byte encryptionStringB[0x10];
 
 FileIO *cFileHandle = nullptr;
 
+#if !RETRO_USE_ORIGINAL_CODE
+// where FileRead reads from, fileBuffer or the mapped pack
+byte *fileData = fileBuffer;
+
+// packs are opened once when they're added & kept open, cFileHandle just borrows them (so it mustn't close them)
+FileIO *packHandles[RETRO_PACK_COUNT];
+int packSizes[RETRO_PACK_COUNT];
+// when each pack was last written, taken when it's added so it matches what's actually being read
+long long packWriteTimes[RETRO_PACK_COUNT];
+bool borrowedFileHandle = false;
+
+FileAccessStats fileAccess;
+#endif
+
+#if RETRO_USING_MMAP
+byte *packMappings[RETRO_PACK_COUNT];
+int packMappingSizes[RETRO_PACK_COUNT];
+byte *mappedPack = NULL;
+
+static void MapPackFile(int packID, FileIO *file)
+{
+    fSeek(file, 0, SEEK_END);
+    int size                 = (int)fTell(file);
+    void *mapping            = size > 0 ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(file), 0) : MAP_FAILED;
+    packMappings[packID]     = NULL;
+    packMappingSizes[packID] = 0;
+    if (mapping == MAP_FAILED) {
+        PrintLog("couldn't map datapack, reading it through stdio instead");
+        return;
+    }
+
+    packMappings[packID]     = (byte *)mapping;
+    packMappingSizes[packID] = size;
+}
+
+#endif
+
+#if !RETRO_USE_ORIGINAL_CODE
+void ReleasePackFiles()
+{
+    if (borrowedFileHandle) {
+        cFileHandle        = NULL;
+        borrowedFileHandle = false;
+    }
+
+    for (int p = 0; p < RETRO_PACK_COUNT; ++p) {
+        if (packHandles[p])
+            fClose(packHandles[p]);
+        packHandles[p]    = NULL;
+        packSizes[p]      = 0;
+        packWriteTimes[p] = 0;
+#if RETRO_USING_MMAP
+        if (packMappings[p])
+            munmap(packMappings[p], packMappingSizes[p]);
+        packMappings[p]     = NULL;
+        packMappingSizes[p] = 0;
+#endif
+    }
+#if RETRO_USING_MMAP
+    mappedPack = NULL;
+#endif
+}
+
+// points the reader at the pack a file's stored in (its mapping, or its open handle) & sets fileSize to the pack's size
+static bool OpenPackFile(byte packID)
+{
+#if RETRO_USING_MMAP
+    mappedPack = packMappings[packID];
+    if (mappedPack) {
+        cFileHandle = NULL;
+        fileSize    = packMappingSizes[packID];
+        return true;
+    }
+#endif
+
+    if (packHandles[packID]) {
+        cFileHandle        = packHandles[packID];
+        borrowedFileHandle = true;
+        fileSize           = packSizes[packID];
+        return true;
+    }
+
+    cFileHandle        = fOpen(rsdkContainer.packNames[packID], "rb");
+    borrowedFileHandle = false;
+    ++fileAccess.opens;
+    if (!cFileHandle)
+        return false;
+    fSeek(cFileHandle, 0, SEEK_END);
+    fileSize = (int)fTell(cFileHandle);
+    fileAccess.seeks += 2;
+    return true;
+}
+
+// with pread every read carries its own position, so there's nothing to seek
+static void SeekFileHandle(int position)
+{
+#if !RETRO_USING_PREAD
+    if (cFileHandle) {
+        fSeek(cFileHandle, position, SEEK_SET);
+        ++fileAccess.seeks;
+    }
+#endif
+}
+
+size_t ReadFileData(void *dest, int size)
+{
+    if (size <= 0 || !cFileHandle)
+        return 0;
+
+    ++fileAccess.reads;
+    fileAccess.readSize += size;
+#if RETRO_USING_PREAD
+    ssize_t result = pread(fileno(cFileHandle), dest, size, readPos);
+    return result > 0 ? (size_t)result : 0;
+#else
+    return fRead(dest, 1u, size, cFileHandle);
+#endif
+}
+
+// when the file was last written, to the nanosecond where that's kept so a rewrite within the same second still shows, 0 where it can't be found out
+static long long GetFileWriteTime(const char *filePath, FileIO *file)
+{
+#if RETRO_PLATFORM == RETRO_LINUX
+    // fcaseopen may have opened it under a different case than it was asked for, so go by the handle where there is one
+    struct stat info;
+    if (file ? fstat(fileno(file), &info) : stat(filePath, &info))
+        return 0;
+    return info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+#elif RETRO_PLATFORM == RETRO_OSX || RETRO_PLATFORM == RETRO_iOS
+    struct stat info;
+    if (stat(filePath, &info))
+        return 0;
+    return info.st_mtimespec.tv_sec * 1000000000LL + info.st_mtimespec.tv_nsec;
+#elif RETRO_PLATFORM == RETRO_WIN || RETRO_PLATFORM == RETRO_UWP
+    struct _stat info;
+    if (_stat(filePath, &info))
+        return 0;
+    return info.st_mtime;
+#elif RETRO_PLATFORM == RETRO_ANDROID || RETRO_PLATFORM == RETRO_SWITCH
+    struct stat info;
+    if (stat(filePath, &info))
+        return 0;
+    return info.st_mtime;
+#else
+    return 0;
+#endif
+}
+
+uint GetFileStamp(const char *filePath)
+{
+    FileInfo info;
+    if (!LoadFile(filePath, &info))
+        return 0;
+
+    long long stamp[4];
+    if (info.usingDataPack) {
+        stamp[0] = info.packID;
+        stamp[1] = info.virtualFileOffset;
+        stamp[2] = info.vfileSize;
+        stamp[3] = packWriteTimes[info.packID];
+    }
+    else {
+        stamp[0] = -1;
+        stamp[1] = 0;
+        stamp[2] = info.vfileSize;
+        stamp[3] = GetFileWriteTime(info.fileName, cFileHandle);
+    }
+    CloseFile();
+
+    // FNV-1a
+    uint hash         = 0x811C9DC5;
+    const byte *bytes = (const byte *)stamp;
+    for (int i = 0; i < (int)sizeof(stamp); ++i) hash = (hash ^ bytes[i]) * 0x01000193;
+
+    // 0 is kept for files that couldn't be stamped
+    return hash ? hash : 1;
+}
+
+void ReportFileAccess()
+{
+    if (!fileAccess.loads)
+        return;
+
+    PrintLog("File access: %d files loaded, %d opens, %d seeks, %d reads (%lld KB), %d readahead hints", fileAccess.loads, fileAccess.opens,
+             fileAccess.seeks, fileAccess.reads, fileAccess.readSize / 1024, fileAccess.advises);
+    PrintLog("File access: reopening packs for every file would've taken %d opens & %d seeks", fileAccess.originalOpens, fileAccess.originalSeeks);
+    MEM_ZERO(fileAccess);
+}
+#endif
+
 bool CheckRSDKFile(const char *filePath)
 {
     FileInfo info;
@@ -49,6 +253,9 @@ bool CheckRSDKFile(const char *filePath)
 #endif
 
         StrCopy(rsdkContainer.packNames[rsdkContainer.packCount], filePathBuffer);
+#if !RETRO_USE_ORIGINAL_CODE
+        packWriteTimes[rsdkContainer.packCount] = GetFileWriteTime(filePathBuffer, cFileHandle);
+#endif
 
         byte b[4];
         fRead(&b, 2, 1, cFileHandle);
@@ -72,7 +279,22 @@ bool CheckRSDKFile(const char *filePath)
             rsdkContainer.fileCount++;
         }
 
+#if !RETRO_USE_ORIGINAL_CODE
+        BuildPackFileIndex();
+#if RETRO_USING_MMAP
+        MapPackFile(rsdkContainer.packCount, cFileHandle);
+        if (packMappings[rsdkContainer.packCount])
+            fClose(cFileHandle);
+        else
+#endif
+        {
+            fSeek(cFileHandle, 0, SEEK_END);
+            packSizes[rsdkContainer.packCount]   = (int)fTell(cFileHandle);
+            packHandles[rsdkContainer.packCount] = cFileHandle;
+        }
+#else
         fClose(cFileHandle);
+#endif
         cFileHandle = NULL;
         if (LoadFile("Bytecode/GlobalCode.bin", &info)) {
             Engine.usingBytecode = true;
@@ -100,30 +322,135 @@ bool CheckRSDKFile(const char *filePath)
 }
 
 #if !RETRO_USE_ORIGINAL_CODE
+#define PACKFILEINDEX_SIZE (RETRO_PACKFILE_COUNT * 2)
+#define FILEPATHMEMO_COUNT (0x100)
+
+// open addressed by the first word of each file's MD5, holding rsdkContainer.files indices + 1 (0 being empty)
+// only the first entry with a given hash goes in, the linear search it replaced always stopped at the first match
+ushort packFileIndex[PACKFILEINDEX_SIZE];
+
+// paths that've been looked up before, so loading them again (global sheets every stage, etc) skips the MD5
+struct FilePathMemo {
+    char path[0x80];
+    int fileIndex;
+};
+FilePathMemo filePathMemo[FILEPATHMEMO_COUNT];
+
+static inline bool MatchFileHash(const RSDKFileInfo *file, const uint *hash)
+{
+    return file->hash[0] == hash[0] && file->hash[1] == hash[1] && file->hash[2] == hash[2] && file->hash[3] == hash[3];
+}
+
+static int ScanPackFiles(const uint *hash)
+{
+    int fileCount = rsdkContainer.fileCount < RETRO_PACKFILE_COUNT ? rsdkContainer.fileCount : RETRO_PACKFILE_COUNT;
+    for (int f = 0; f < fileCount; ++f) {
+        if (MatchFileHash(&rsdkContainer.files[f], hash))
+            return f;
+    }
+    return -1;
+}
+
+static int FindPackFile(const uint *hash)
+{
+    for (int i = 0; i < PACKFILEINDEX_SIZE; ++i) {
+        int slot = (hash[0] + i) & (PACKFILEINDEX_SIZE - 1);
+        if (!packFileIndex[slot])
+            break;
+        if (MatchFileHash(&rsdkContainer.files[packFileIndex[slot] - 1], hash))
+            return packFileIndex[slot] - 1;
+    }
+    return -1;
+}
+
+void BuildPackFileIndex()
+{
+    memset(packFileIndex, 0, sizeof(packFileIndex));
+    memset(filePathMemo, 0, sizeof(filePathMemo));
+
+    int fileCount = rsdkContainer.fileCount < RETRO_PACKFILE_COUNT ? rsdkContainer.fileCount : RETRO_PACKFILE_COUNT;
+    for (int f = 0; f < fileCount; ++f) {
+        uint *hash = rsdkContainer.files[f].hash;
+        if (FindPackFile(hash) >= 0)
+            continue;
+
+        int slot = hash[0] & (PACKFILEINDEX_SIZE - 1);
+        while (packFileIndex[slot]) slot = (slot + 1) & (PACKFILEINDEX_SIZE - 1);
+        packFileIndex[slot] = f + 1;
+    }
+}
+
 int CheckFileInfo(const char *filepath)
 {
+    uint pathHash = 0x811C9DC5;
+    for (const char *c = filepath; *c; ++c) pathHash = (pathHash ^ (byte)*c) * 0x01000193;
+    FilePathMemo *memo = &filePathMemo[pathHash & (FILEPATHMEMO_COUNT - 1)];
+    if (memo->path[0] && !strcmp(memo->path, filepath))
+        return memo->fileIndex;
+
     char pathBuf[0x100];
     StrCopy(pathBuf, filepath);
     uint hash[4];
     int len = StrLength(pathBuf);
     GenerateMD5FromString(pathBuf, len, &hash[0], &hash[1], &hash[2], &hash[3]);
 
-    for (int f = 0; f < rsdkContainer.fileCount; ++f) {
-        RSDKFileInfo *file = &rsdkContainer.files[f];
+    int fileIndex = FindPackFile(hash);
+    if (len < (int)sizeof(memo->path)) {
+        StrCopy(memo->path, filepath);
+        memo->fileIndex = fileIndex;
+    }
+    return fileIndex;
+}
 
-        bool match = true;
-        for (int h = 0; h < 4; ++h) {
-            if (hash[h] != file->hash[h]) {
-                match = false;
-                break;
+void BenchmarkFileIndex()
+{
+    // every directory entry has to resolve to the entry the linear search finds
+    int mismatches = 0;
+    int fileCount  = rsdkContainer.fileCount < RETRO_PACKFILE_COUNT ? rsdkContainer.fileCount : RETRO_PACKFILE_COUNT;
+    for (int f = 0; f < fileCount; ++f) {
+        if (FindPackFile(rsdkContainer.files[f].hash) != ScanPackFiles(rsdkContainer.files[f].hash))
+            ++mismatches;
+    }
+
+    // then by path, cycling through files every game has & whatever's been loaded so far
+    const char *commonPaths[] = { "data/game/gameconfig.bin",      "bytecode/globalcode.bin",         "data/palettes/masterpalette.act",
+                                  "data/sprites/global/items.gif", "data/sprites/global/display.gif", "data/animations/global/items.ani",
+                                  "data/game/systemtext.gif",      "data/stages/missing/act1.bin" };
+    const int commonCount = sizeof(commonPaths) / sizeof(commonPaths[0]);
+    char(*paths)[0x80]    = new char[commonCount + FILEPATHMEMO_COUNT][0x80];
+    int pathCount         = 0;
+    for (int p = 0; p < commonCount; ++p) StrCopy(paths[pathCount++], commonPaths[p]);
+    for (int m = 0; m < FILEPATHMEMO_COUNT; ++m) {
+        if (filePathMemo[m].path[0])
+            StrCopy(paths[pathCount++], filePathMemo[m].path);
+    }
+
+    const int lookupCount = 10000;
+    double freq           = (double)SDL_GetPerformanceFrequency() / 1000.0;
+    double time[3]        = { 0.0, 0.0, 0.0 };
+    int results[3]        = { 0, 0, 0 };
+    for (int k = 0; k < 3; ++k) {
+        unsigned long long start = SDL_GetPerformanceCounter();
+        for (int i = 0; i < lookupCount; ++i) {
+            const char *path = paths[i % pathCount];
+            if (k == 2) {
+                results[k] += CheckFileInfo(path) * (i + 1);
+                continue;
             }
-        }
-        if (!match)
-            continue;
 
-        return f;
+            uint hash[4];
+            GenerateMD5FromString(path, StrLength(path), &hash[0], &hash[1], &hash[2], &hash[3]);
+            results[k] += (k ? FindPackFile(hash) : ScanPackFiles(hash)) * (i + 1);
+        }
+        time[k] = (SDL_GetPerformanceCounter() - start) / freq;
     }
-    return -1;
+    if (results[1] != results[0] || results[2] != results[0])
+        ++mismatches;
+
+    PrintLog("File index benchmark: %d lookups over %d paths, linear %.4fms, hashed %.4fms (%.2fx), memoised %.4fms (%.2fx)", lookupCount,
+             pathCount, time[0], time[1], time[1] > 0.0 ? time[0] / time[1] : 0.0, time[2], time[2] > 0.0 ? time[0] / time[2] : 0.0);
+    PrintLog("File index benchmark: %d directory entries, %d mismatches", fileCount, mismatches);
+    delete[] paths;
 }
 
 inline bool ends_with(std::string const &value, std::string const &ending)
@@ -138,7 +465,11 @@ bool LoadFile(const char *filePath, FileInfo *fileInfo)
 {
     MEM_ZEROP(fileInfo);
 
+#if !RETRO_USE_ORIGINAL_CODE
+    if (cFileHandle && !borrowedFileHandle)
+#else
     if (cFileHandle)
+#endif
         fClose(cFileHandle);
 
     char filePathBuf[0x100];
@@ -194,25 +525,37 @@ bool LoadFile(const char *filePath, FileInfo *fileInfo)
 #endif
 
     cFileHandle = NULL;
+#if RETRO_USING_MMAP
+    mappedPack = NULL;
+#endif
 #if !RETRO_USE_ORIGINAL_CODE
+    borrowedFileHandle = false;
     StringLowerCase(fileInfo->fileName, filePath);
     StrCopy(fileName, fileInfo->fileName);
 
     int fileIndex = CheckFileInfo(fileName);
     if (fileIndex != -1 && !forceFolder) {
         RSDKFileInfo *file = &rsdkContainer.files[fileIndex];
-        packID      = file->packID;
-        cFileHandle = fOpen(rsdkContainer.packNames[file->packID], "rb");
-        if (cFileHandle) {
-            fSeek(cFileHandle, 0, SEEK_END);
-            fileSize = (int)fTell(cFileHandle);
-
+        packID = file->packID;
+        if (OpenPackFile(packID)) {
             vFileSize         = file->filesize;
             virtualFileOffset = file->offset;
             readPos           = file->offset;
             readSize          = 0;
             bufferPosition    = 0;
-            fSeek(cFileHandle, virtualFileOffset, SEEK_SET);
+            SeekFileHandle(virtualFileOffset);
+#if RETRO_USING_MMAP
+            // files are almost always read start to finish, so get the kernel reading ahead now
+            if (mappedPack && vFileSize > 0 && virtualFileOffset + vFileSize <= fileSize) {
+                size_t pageMask = (size_t)sysconf(_SC_PAGESIZE) - 1;
+                size_t start    = (size_t)virtualFileOffset & ~pageMask;
+                madvise(&mappedPack[start], virtualFileOffset + vFileSize - start, MADV_WILLNEED);
+                ++fileAccess.advises;
+            }
+#endif
+            ++fileAccess.loads;
+            ++fileAccess.originalOpens;
+            fileAccess.originalSeeks += 3;
 
             useEncryption = file->encrypted;
             memset(fileInfo->encryptionStringA, 0, 0x10 * sizeof(byte));
@@ -330,6 +673,13 @@ bool LoadFile(const char *filePath, FileInfo *fileInfo)
         fileInfo->fileSize = (int)fTell(cFileHandle);
         fileSize = fileInfo->vfileSize = fileInfo->fileSize;
         fSeek(cFileHandle, 0, SEEK_SET);
+#if !RETRO_USE_ORIGINAL_CODE
+        ++fileAccess.loads;
+        ++fileAccess.opens;
+        fileAccess.seeks += 3;
+        ++fileAccess.originalOpens;
+        fileAccess.originalSeeks += 3;
+#endif
         readPos           = 0;
         fileInfo->readPos = readPos;
         packID = fileInfo->packID = -1;
@@ -391,6 +741,270 @@ const uint ENC_KEY_2 = 0x24924925;
 const uint ENC_KEY_1 = 0xAAAAAAAB;
 int mulUnsignedHigh(uint arg1, int arg2) { return (int)(((unsigned long long)arg1 * (unsigned long long)arg2) >> 32); }
 
+#if !RETRO_USE_ORIGINAL_CODE
+// from any starting eStringNo the key schedule runs at most 2283 bytes before it starts repeating
+#define KEYSCHEDULE_SIZE      (0x900)
+#define BULKDECRYPT_MIN_SIZE  (0x10)
+
+struct EncryptionState {
+    byte posA;
+    byte posB;
+    byte stringNo;
+    byte nybbleSwap;
+};
+
+// the eString state at each byte for one starting eStringNo, from tail + period on it repeats from tail
+struct KeySchedule {
+    int tail;
+    int period;
+    EncryptionState states[KEYSCHEDULE_SIZE];
+};
+
+// the open file's decryption laid out a byte at a time, each byte's (nybble swapped where swapMask is set) ^ key
+// it's only built as far as it's been read
+struct Keystream {
+    int fileSize;
+    byte stringA[0x10];
+    byte stringB[0x10];
+    KeySchedule *schedule;
+    int length;
+    byte key[KEYSCHEDULE_SIZE];
+    byte swapMask[KEYSCHEDULE_SIZE];
+};
+
+KeySchedule keySchedules[0x80];
+Keystream keystream;
+bool useBulkDecryption = true;
+
+// the same steps FileRead takes after every byte
+static inline void StepEncryptionState(EncryptionState *state)
+{
+    ++state->posA;
+    ++state->posB;
+    if (state->posA <= 0x0F) {
+        if (state->posB > 0x0C) {
+            state->posB = 0;
+            state->nybbleSwap ^= 0x01;
+        }
+    }
+    else if (state->posB <= 0x08) {
+        state->posA = 0;
+        state->nybbleSwap ^= 0x01;
+    }
+    else {
+        state->stringNo += 2;
+        state->stringNo &= 0x7F;
+
+        int key1  = mulUnsignedHigh(ENC_KEY_1, state->stringNo);
+        int key2  = mulUnsignedHigh(ENC_KEY_2, state->stringNo);
+        int temp1 = key2 + (state->stringNo - key2) / 2;
+        int temp2 = key1 / 8 * 3;
+        if (state->nybbleSwap != 0) {
+            state->nybbleSwap = 0;
+            state->posA       = state->stringNo - temp1 / 4 * 7;
+            state->posB       = state->stringNo - temp2 * 4 + 2;
+        }
+        else {
+            state->nybbleSwap = 1;
+            state->posB       = state->stringNo - temp1 / 4 * 7;
+            state->posA       = state->stringNo - temp2 * 4 + 3;
+        }
+    }
+}
+
+static inline bool MatchEncryptionState(const EncryptionState *a, const EncryptionState *b)
+{
+    return a->posA == b->posA && a->posB == b->posB && a->stringNo == b->stringNo && a->nybbleSwap == b->nybbleSwap;
+}
+
+// finds where the schedule starting at stringNo loops back on itself (brent's cycle detection) & records it up to there
+static KeySchedule *GetKeySchedule(byte stringNo)
+{
+    KeySchedule *schedule = &keySchedules[stringNo];
+    if (schedule->period)
+        return schedule->period > 0 ? schedule : NULL;
+
+    EncryptionState start    = { 0, 8, stringNo, 0 };
+    EncryptionState tortoise = start;
+    EncryptionState hare     = start;
+    StepEncryptionState(&hare);
+
+    int power  = 1;
+    int period = 1;
+    while (!MatchEncryptionState(&tortoise, &hare)) {
+        if (power == period) {
+            tortoise = hare;
+            power *= 2;
+            period = 0;
+        }
+        StepEncryptionState(&hare);
+        ++period;
+    }
+
+    int tail = 0;
+    tortoise = hare = start;
+    for (int i = 0; i < period; ++i) StepEncryptionState(&hare);
+    while (!MatchEncryptionState(&tortoise, &hare)) {
+        StepEncryptionState(&tortoise);
+        StepEncryptionState(&hare);
+        ++tail;
+    }
+
+    if (tail + period > KEYSCHEDULE_SIZE) {
+        schedule->period = -1;
+        return NULL;
+    }
+
+    schedule->tail      = tail;
+    schedule->period    = period;
+    schedule->states[0] = start;
+    for (int i = 1; i < tail + period; ++i) {
+        schedule->states[i] = schedule->states[i - 1];
+        StepEncryptionState(&schedule->states[i]);
+    }
+    return schedule;
+}
+
+// the keystream only depends on the file's size & the keys made from it, so it's kept until either changes
+static bool PrepareKeystream()
+{
+    if (keystream.fileSize != vFileSize || !keystream.schedule || memcmp(keystream.stringA, encryptionStringA, 0x10)
+        || memcmp(keystream.stringB, encryptionStringB, 0x10)) {
+        keystream.fileSize = vFileSize;
+        keystream.schedule = GetKeySchedule((vFileSize & 0x1FC) >> 2);
+        keystream.length   = 0;
+        memcpy(keystream.stringA, encryptionStringA, 0x10);
+        memcpy(keystream.stringB, encryptionStringB, 0x10);
+    }
+    return keystream.schedule != NULL;
+}
+
+static inline int GetKeystreamIndex(int position)
+{
+    KeySchedule *schedule = keystream.schedule;
+    int end               = schedule->tail + schedule->period;
+    return position < end ? position : schedule->tail + (position - schedule->tail) % schedule->period;
+}
+
+static void ExtendKeystream(int length)
+{
+    for (; keystream.length < length; ++keystream.length) {
+        const EncryptionState *state = &keystream.schedule->states[keystream.length];
+        byte key                     = keystream.stringB[state->posB] ^ state->stringNo;
+        if (state->nybbleSwap)
+            key = ((key << 4) + (key >> 4)) & 0xFF;
+        keystream.key[keystream.length]      = key ^ keystream.stringA[state->posA];
+        keystream.swapMask[keystream.length] = state->nybbleSwap ? 0xFF : 0x00;
+    }
+}
+
+static inline const EncryptionState *GetKeystreamState(int position) { return &keystream.schedule->states[GetKeystreamIndex(position)]; }
+
+static inline void SetEncryptionState(const EncryptionState *state)
+{
+    eStringPosA = state->posA;
+    eStringPosB = state->posB;
+    eStringNo   = state->stringNo;
+    eNybbleSwap = state->nybbleSwap;
+}
+
+// nybbles are swapped with a shift & mask, then picked per byte by swapMask & xored with the key
+static void ApplyKeystream(byte *dest, const byte *src, const byte *key, const byte *swapMask, int count)
+{
+    int i = 0;
+#if RETRO_USING_SSE2
+    if (Engine.useSIMD) {
+        const __m128i lowMask = _mm_set1_epi8(0x0F);
+        for (; i + 16 <= count; i += 16) {
+            __m128i in      = _mm_loadu_si128((const __m128i *)&src[i]);
+            __m128i mask    = _mm_loadu_si128((const __m128i *)&swapMask[i]);
+            __m128i swapped = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(in, lowMask), 4), _mm_and_si128(_mm_srli_epi16(in, 4), lowMask));
+            __m128i out     = _mm_or_si128(_mm_and_si128(mask, swapped), _mm_andnot_si128(mask, in));
+            _mm_storeu_si128((__m128i *)&dest[i], _mm_xor_si128(out, _mm_loadu_si128((const __m128i *)&key[i])));
+        }
+    }
+#elif RETRO_USING_NEON
+    if (Engine.useSIMD) {
+        for (; i + 16 <= count; i += 16) {
+            uint8x16_t in      = vld1q_u8(&src[i]);
+            uint8x16_t swapped = vorrq_u8(vshlq_n_u8(in, 4), vshrq_n_u8(in, 4));
+            uint8x16_t out     = vbslq_u8(vld1q_u8(&swapMask[i]), swapped, in);
+            vst1q_u8(&dest[i], veorq_u8(out, vld1q_u8(&key[i])));
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        byte swapped = ((src[i] << 4) + (src[i] >> 4)) & 0xFF;
+        dest[i]      = ((swapped & swapMask[i]) | (src[i] & ~swapMask[i])) ^ key[i];
+    }
+}
+
+// decrypts as much of a read as is buffered (or mapped) in runs of keystream, leaving the eString state where the byte loop would
+static int DecryptFileData(byte *dest, int size)
+{
+    if (!useBulkDecryption || !PrepareKeystream())
+        return 0;
+
+    int position            = bufferPosition + readPos - readSize - virtualFileOffset;
+    EncryptionState current = { eStringPosA, eStringPosB, eStringNo, eNybbleSwap };
+    if (position < 0 || !MatchEncryptionState(&current, GetKeystreamState(position)))
+        return 0;
+
+    int done = 0;
+    while (done < size) {
+        if (bufferPosition == readSize)
+            FillFileBuffer();
+        if (bufferPosition >= readSize)
+            break;
+
+        int count = readSize - bufferPosition < size - done ? readSize - bufferPosition : size - done;
+        while (count > 0) {
+            int index = GetKeystreamIndex(position);
+            int run   = keystream.schedule->tail + keystream.schedule->period - index;
+            if (run > count)
+                run = count;
+            ExtendKeystream(index + run);
+            ApplyKeystream(&dest[done], &fileData[bufferPosition], &keystream.key[index], &keystream.swapMask[index], run);
+            bufferPosition += run;
+            position += run;
+            done += run;
+            count -= run;
+        }
+    }
+
+    SetEncryptionState(GetKeystreamState(position));
+    return done;
+}
+
+// skips what's buffered (or mapped) without stepping through the schedule byte by byte
+static int SkipFileData(int count)
+{
+    if (!useBulkDecryption || !PrepareKeystream())
+        return 0;
+
+    int position            = bufferPosition + readPos - readSize - virtualFileOffset;
+    EncryptionState current = { eStringPosA, eStringPosB, eStringNo, eNybbleSwap };
+    if (position < 0 || !MatchEncryptionState(&current, GetKeystreamState(position)))
+        return 0;
+
+    int done = 0;
+    while (done < count) {
+        if (bufferPosition == readSize)
+            FillFileBuffer();
+        if (bufferPosition >= readSize)
+            break;
+
+        int skip = readSize - bufferPosition < count - done ? readSize - bufferPosition : count - done;
+        bufferPosition += skip;
+        position += skip;
+        done += skip;
+    }
+
+    SetEncryptionState(GetKeystreamState(position));
+    return done;
+}
+#endif
+
 void FileRead(void *dest, int size)
 {
     byte *data = (byte *)dest;
@@ -398,11 +1012,25 @@ void FileRead(void *dest, int size)
 
     if (readPos <= fileSize) {
         if (useEncryption) {
+#if !RETRO_USE_ORIGINAL_CODE
+            if (size >= BULKDECRYPT_MIN_SIZE) {
+                int count = DecryptFileData(data, size);
+                data += count;
+                size -= count;
+            }
+#endif
             while (size > 0) {
                 if (bufferPosition == readSize)
                     FillFileBuffer();
 
+#if !RETRO_USE_ORIGINAL_CODE
+                // past the end of the pack, there's nothing (mapped) to read
+                if (bufferPosition >= readSize)
+                    break;
+                *data = encryptionStringB[eStringPosB] ^ eStringNo ^ fileData[bufferPosition++];
+#else
                 *data = encryptionStringB[eStringPosB] ^ eStringNo ^ fileBuffer[bufferPosition++];
+#endif
                 if (eNybbleSwap)
                     *data = ((*data << 4) + (*data >> 4)) & 0xFF;
                 *data ^= encryptionStringA[eStringPosA];
@@ -452,6 +1080,21 @@ void FileRead(void *dest, int size)
             }
         }
         else {
+#if !RETRO_USE_ORIGINAL_CODE
+            // copied a buffer (or with a mapped pack, the whole read) at a time
+            while (size > 0) {
+                if (bufferPosition == readSize)
+                    FillFileBuffer();
+                if (bufferPosition >= readSize)
+                    break;
+
+                int count = readSize - bufferPosition < size ? readSize - bufferPosition : size;
+                memcpy(data, &fileData[bufferPosition], count);
+                bufferPosition += count;
+                data += count;
+                size -= count;
+            }
+#else
             while (size > 0) {
                 if (bufferPosition == readSize)
                     FillFileBuffer();
@@ -459,6 +1102,7 @@ void FileRead(void *dest, int size)
                 *data++ = fileBuffer[bufferPosition++];
                 size--;
             }
+#endif
         }
     }
 }
@@ -467,6 +1111,10 @@ void FileSkip(int count)
 {
     if (readPos <= fileSize) {
         if (useEncryption) {
+#if !RETRO_USE_ORIGINAL_CODE
+            if (count >= BULKDECRYPT_MIN_SIZE)
+                count -= SkipFileData(count);
+#endif
             while (count > 0) {
                 if (bufferPosition == readSize)
                     FillFileBuffer();
@@ -516,12 +1164,25 @@ void FileSkip(int count)
             }
         }
         else {
+#if !RETRO_USE_ORIGINAL_CODE
+            while (count > 0) {
+                if (bufferPosition == readSize)
+                    FillFileBuffer();
+                if (bufferPosition >= readSize)
+                    break;
+
+                int skip = readSize - bufferPosition < count ? readSize - bufferPosition : count;
+                bufferPosition += skip;
+                count -= skip;
+            }
+#else
             while (count > 0) {
                 if (bufferPosition == readSize)
                     FillFileBuffer();
                 bufferPosition++;
                 count--;
             }
+#endif
         }
     }
 }
@@ -549,9 +1210,15 @@ void SetFileInfo(FileInfo *fileInfo)
 {
 #if !RETRO_USE_ORIGINAL_CODE
     if (fileInfo->usingDataPack) {
+        if (OpenPackFile(fileInfo->packID)) {
+            virtualFileOffset = fileInfo->virtualFileOffset;
+            vFileSize         = fileInfo->vfileSize;
+            readPos           = fileInfo->readPos;
+            SeekFileHandle(readPos);
+            ++fileAccess.originalOpens;
+            fileAccess.originalSeeks += 3;
 #else
     if (Engine.usingDataFile) {
-#endif
         cFileHandle = fOpen(rsdkContainer.packNames[fileInfo->packID], "rb");
         if (cFileHandle) {
             virtualFileOffset = fileInfo->virtualFileOffset;
@@ -560,6 +1227,7 @@ void SetFileInfo(FileInfo *fileInfo)
             fileSize = (int)fTell(cFileHandle);
             readPos  = fileInfo->readPos;
             fSeek(cFileHandle, readPos, SEEK_SET);
+#endif
             FillFileBuffer();
             bufferPosition       = fileInfo->bufferPosition;
             eStringPosA          = fileInfo->eStringPosA;
@@ -577,11 +1245,22 @@ void SetFileInfo(FileInfo *fileInfo)
     }
     else {
         StrCopy(fileName, fileInfo->fileName);
+#if RETRO_USING_MMAP
+        mappedPack = NULL;
+#endif
         cFileHandle       = fOpen(fileInfo->fileName, "rb");
         virtualFileOffset = 0;
         fileSize          = fileInfo->fileSize;
         readPos           = fileInfo->readPos;
+#if !RETRO_USE_ORIGINAL_CODE
+        borrowedFileHandle = false;
+        ++fileAccess.opens;
+        ++fileAccess.originalOpens;
+        ++fileAccess.originalSeeks;
+        SeekFileHandle(readPos);
+#else
         fSeek(cFileHandle, readPos, SEEK_SET);
+#endif
         FillFileBuffer();
         bufferPosition       = fileInfo->bufferPosition;
         eStringPosA          = 0;
@@ -610,6 +1289,13 @@ void SetFilePosition(int newPos)
         eStringPosA = 0;
         eStringPosB = 8;
         eNybbleSwap = false;
+#if !RETRO_USE_ORIGINAL_CODE
+        // the key schedule's state at newPos is looked up rather than stepped to
+        if (newPos > 0 && useBulkDecryption && PrepareKeystream()) {
+            SetEncryptionState(GetKeystreamState(newPos));
+            newPos = 0;
+        }
+#endif
         while (newPos) {
             ++eStringPosA;
             ++eStringPosB;
@@ -659,7 +1345,12 @@ void SetFilePosition(int newPos)
         else
             readPos = newPos;
     }
+#if !RETRO_USE_ORIGINAL_CODE
+    ++fileAccess.originalSeeks;
+    SeekFileHandle(readPos);
+#else
     fSeek(cFileHandle, readPos, SEEK_SET);
+#endif
     FillFileBuffer();
 }
 
@@ -670,3 +1361,76 @@ bool ReachedEndOfFile()
     else
         return bufferPosition + readPos - readSize >= fileSize;
 }
+
+#if !RETRO_USE_ORIGINAL_CODE
+void BenchmarkDecryption()
+{
+    // every encrypted file in the packs is decrypted both ways, the results & the eString state left behind have to match
+    int fileCount   = rsdkContainer.fileCount < RETRO_PACKFILE_COUNT ? rsdkContainer.fileCount : RETRO_PACKFILE_COUNT;
+    int maxSize     = 0;
+    int checkCount  = 0;
+    long long total = 0;
+    for (int f = 0; f < fileCount; ++f) {
+        if (rsdkContainer.files[f].encrypted && rsdkContainer.files[f].filesize > 0) {
+            if (rsdkContainer.files[f].filesize > maxSize)
+                maxSize = rsdkContainer.files[f].filesize;
+            ++checkCount;
+            total += rsdkContainer.files[f].filesize;
+        }
+    }
+    if (!checkCount) {
+        PrintLog("Decryption benchmark: no encrypted files to check");
+        return;
+    }
+
+    byte *buffers[2]        = { new byte[maxSize], new byte[maxSize] };
+    EncryptionState ends[2] = {};
+    double freq             = (double)SDL_GetPerformanceFrequency() / 1000.0;
+    double time[2]          = { 0.0, 0.0 };
+    int mismatches          = 0;
+    for (int f = 0; f < fileCount; ++f) {
+        RSDKFileInfo *file = &rsdkContainer.files[f];
+        if (!file->encrypted || file->filesize <= 0)
+            continue;
+
+        int k = 0;
+        for (; k < 2; ++k) {
+            CloseFile();
+            if (!OpenPackFile(file->packID))
+                break;
+            vFileSize         = file->filesize;
+            virtualFileOffset = file->offset;
+            readPos           = file->offset;
+            readSize          = 0;
+            bufferPosition    = 0;
+            useEncryption     = true;
+            packID            = file->packID;
+            SeekFileHandle(virtualFileOffset);
+            GenerateELoadKeys(vFileSize, (vFileSize >> 1) + 1);
+            eStringNo   = (vFileSize & 0x1FC) >> 2;
+            eStringPosA = 0;
+            eStringPosB = 8;
+            eNybbleSwap = 0;
+
+            useBulkDecryption        = k == 1;
+            unsigned long long start = SDL_GetPerformanceCounter();
+            FileRead(buffers[k], vFileSize);
+            time[k] += (SDL_GetPerformanceCounter() - start) / freq;
+
+            EncryptionState end = { eStringPosA, eStringPosB, eStringNo, eNybbleSwap };
+            ends[k]             = end;
+        }
+        if (k < 2 || memcmp(buffers[0], buffers[1], file->filesize) || !MatchEncryptionState(&ends[0], &ends[1]))
+            ++mismatches;
+    }
+    useBulkDecryption = true;
+    CloseFile();
+
+    double size = total / (1024.0 * 1024.0);
+    PrintLog("Decryption benchmark: %d encrypted files (%lld KB), byte-wise %.4fms (%.2f MB/s), bulk %.4fms (%.2f MB/s), %d mismatches",
+             checkCount, total / 1024, time[0], time[0] > 0.0 ? size / (time[0] / 1000.0) : 0.0, time[1],
+             time[1] > 0.0 ? size / (time[1] / 1000.0) : 0.0, mismatches);
+    delete[] buffers[0];
+    delete[] buffers[1];
+}
+#endif
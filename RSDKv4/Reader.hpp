@@ -49,6 +49,19 @@
 
 #endif
 
+// data packs are mapped into memory & read straight out of the mapping, stdio's still used if mapping one fails
+#if !RETRO_USE_ORIGINAL_CODE && RETRO_PLATFORM == RETRO_LINUX
+#define RETRO_USING_MMAP (1)
+#else
+#define RETRO_USING_MMAP (0)
+#endif
+
+// packs that can't be mapped are still read through one handle each, positioned per read with pread where FileIO is a FILE
+#if !RETRO_USE_ORIGINAL_CODE && RETRO_PLATFORM == RETRO_LINUX
+#define RETRO_USING_PREAD (1)
+#else
+#define RETRO_USING_PREAD (0)
+#endif
 
 #define RETRO_PACKFILE_COUNT (0x1000)
 #define RETRO_PACK_COUNT     (0x4)
@@ -82,6 +95,20 @@ struct RSDKFileInfo {
     byte packID;
 };
 
+#if !RETRO_USE_ORIGINAL_CODE
+// what the reader's asked the OS for since the last report
+struct FileAccessStats {
+    int loads;
+    int opens;
+    int seeks;
+    int reads;
+    int advises;
+    long long readSize;
+    int originalOpens;
+    int originalSeeks;
+};
+#endif
+
 struct RSDKContainer {
     RSDKFileInfo files[RETRO_PACKFILE_COUNT];
     char packNames[RETRO_PACK_COUNT][0x400];
@@ -109,6 +136,14 @@ extern byte encryptionStringA[0x10];
 extern byte encryptionStringB[0x10];
 
 extern FileIO *cFileHandle;
+#if !RETRO_USE_ORIGINAL_CODE
+extern byte *fileData;
+extern bool borrowedFileHandle;
+extern FileAccessStats fileAccess;
+#endif
+#if RETRO_USING_MMAP
+extern byte *mappedPack;
+#endif
 
 inline void CopyFilePath(char *dest, const char *src)
 {
@@ -123,6 +158,10 @@ inline void CopyFilePath(char *dest, const char *src)
     }
 }
 bool CheckRSDKFile(const char *filePath);
+#if !RETRO_USE_ORIGINAL_CODE
+void BuildPackFileIndex();
+void ReleasePackFiles();
+#endif
 inline void CloseRSDKContainers()
 {
     for (int i = 0; i < 4; ++i) {
@@ -130,20 +169,40 @@ inline void CloseRSDKContainers()
     }
     rsdkContainer.packCount = 0;
     rsdkContainer.fileCount = 0;
+#if !RETRO_USE_ORIGINAL_CODE
+    BuildPackFileIndex();
+    ReleasePackFiles();
+#endif
 }
 
 #if !RETRO_USE_ORIGINAL_CODE
 int CheckFileInfo(const char *filepath);
+void BenchmarkFileIndex();
+void BenchmarkDecryption();
+size_t ReadFileData(void *dest, int size);
+void ReportFileAccess();
+// stands in for hashing a file's contents without reading them: where it's stored, its size & when it (or its pack) was last written
+uint GetFileStamp(const char *filePath);
 #endif
 
 bool LoadFile(const char *filePath, FileInfo *fileInfo);
 inline bool CloseFile()
 {
     int result = 0;
+#if !RETRO_USE_ORIGINAL_CODE
+    if (cFileHandle && !borrowedFileHandle)
+#else
     if (cFileHandle)
+#endif
         result = fClose(cFileHandle);
 
     cFileHandle = NULL;
+#if !RETRO_USE_ORIGINAL_CODE
+    borrowedFileHandle = false;
+#endif
+#if RETRO_USING_MMAP
+    mappedPack = NULL;
+#endif
     return result;
 }
 
@@ -154,14 +213,32 @@ void FileSkip(int count);
 
 inline size_t FillFileBuffer()
 {
+#if RETRO_USING_MMAP
+    if (mappedPack) {
+        // the rest of the mapped pack stands in for the buffer, so nothing's copied & the position maths stays the same
+        readSize       = readPos < fileSize ? fileSize - readPos : 0;
+        fileData       = &mappedPack[readPos < fileSize ? readPos : fileSize];
+        readPos        = readPos + readSize;
+        bufferPosition = 0;
+        return readSize;
+    }
+#endif
+
     if (readPos + 0x2000 <= fileSize)
         readSize = 0x2000;
     else
         readSize = fileSize - readPos;
 
+#if !RETRO_USE_ORIGINAL_CODE
+    size_t result = ReadFileData(fileBuffer, readSize);
+#else
     size_t result = fRead(fileBuffer, 1u, readSize, cFileHandle);
+#endif
     readPos += readSize;
     bufferPosition = 0;
+#if !RETRO_USE_ORIGINAL_CODE
+    fileData = fileBuffer;
+#endif
     return result;
 }
 
@@ -0,0 +1,569 @@
+#include "RetroEngine.hpp"
+
+#if !RETRO_USE_ORIGINAL_CODE
+#if RETRO_SOFTWARE_RENDER
+// a made up sprite rect on the sheet, with some of them hanging off the edges of the screen
+inline void GetRenderCheckSprite(int i, int *XPos, int *YPos, int *width, int *height, int *sprX, int *sprY)
+{
+    *width  = 16 + (i * 13) % 96;
+    *height = 16 + (i * 7) % 80;
+    *XPos   = (i * 53) % (GFX_LINESIZE + 48) - 32;
+    *YPos   = (i * 37) % (SCREEN_YSIZE + 48) - 32;
+    *sprX   = (i * 29) % (BENCHMARK_SHEET_SIZE - *width);
+    *sprY   = (i * 41) % (BENCHMARK_SHEET_SIZE - *height);
+}
+
+// a skewed quad, with the texture coords covering a different part of the sheet each time
+inline void GetRenderCheckQuad(int i, Vertex *quad)
+{
+    int x    = (i * 71) % (GFX_LINESIZE + 32) - 16;
+    int y    = (i * 43) % (SCREEN_YSIZE + 32) - 16;
+    int size = 24 + (i * 17) % 64;
+    int skew = (i * 11) % 24 - 12;
+    int uv   = (i * 23) % (BENCHMARK_SHEET_SIZE - size);
+    MEM_ZERO(quad[0]);
+    MEM_ZERO(quad[1]);
+    MEM_ZERO(quad[2]);
+    MEM_ZERO(quad[3]);
+    quad[0].x = x;
+    quad[0].y = y;
+    quad[1].x = x + size;
+    quad[1].y = y + skew;
+    quad[2].x = x - skew;
+    quad[2].y = y + size;
+    quad[3].x = x + size - skew;
+    quad[3].y = y + size + skew;
+    quad[0].u = uv;
+    quad[0].v = uv;
+    quad[1].u = uv + size;
+    quad[1].v = uv;
+    quad[2].u = uv;
+    quad[2].v = uv + size;
+    quad[3].u = uv + size;
+    quad[3].v = uv + size;
+}
+
+void RenderCheckSprites(int sheetID)
+{
+    int x, y, w, h, sprX, sprY;
+    for (int i = 0; i < 32; ++i) {
+        GetRenderCheckSprite(i, &x, &y, &w, &h, &sprX, &sprY);
+        if (i & 1)
+            DrawSprite(x, y, w, h, sprX, sprY, sheetID);
+        else
+            DrawSpriteFlipped(x, y, w, h, sprX, sprY, (i >> 1) & 3, sheetID);
+    }
+}
+
+void RenderCheckTransformedSprites(int sheetID)
+{
+    int x, y, w, h, sprX, sprY;
+    for (int i = 0; i < 24; ++i) {
+        GetRenderCheckSprite(i, &x, &y, &w, &h, &sprX, &sprY);
+        int scale    = 0x100 + (i * 0x29) % 0x180;
+        int rotation = (i * 0x47) & 0x1FF;
+        switch (i % 4) {
+            case 0: DrawSpriteScaled(i & 1, x, y, -(w >> 1), -(h >> 1), scale, scale, w, h, sprX, sprY, sheetID); break;
+            case 1: DrawSpriteRotated(i & 1, x, y, -(w >> 1), -(h >> 1), sprX, sprY, w, h, rotation, sheetID); break;
+            case 2: DrawSpriteRotozoom(i & 1, x, y, -(w >> 1), -(h >> 1), sprX, sprY, w, h, rotation, scale, sheetID); break;
+            case 3: DrawScaledTintMask(i & 1, x, y, -(w >> 1), -(h >> 1), scale, scale, w, h, sprX, sprY, sheetID); break;
+        }
+    }
+#if RETRO_REV00 || RETRO_REV01
+    DrawScaledChar(FLIP_NONE, SCREEN_CENTERX, SCREEN_CENTERY, -32, -32, 0x300, 0x300, 64, 64, 16, 16, sheetID);
+#endif
+}
+
+void RenderCheckBlendedSprites(int sheetID)
+{
+    int x, y, w, h, sprX, sprY;
+    for (int i = 0; i < 32; ++i) {
+        GetRenderCheckSprite(i, &x, &y, &w, &h, &sprX, &sprY);
+        int alpha = (i * 0x25) & 0x1FF;
+        switch (i % 4) {
+            case 0: DrawBlendedSprite(x, y, w, h, sprX, sprY, sheetID); break;
+            case 1: DrawAlphaBlendedSprite(x, y, w, h, sprX, sprY, alpha, sheetID); break;
+            case 2: DrawAdditiveBlendedSprite(x, y, w, h, sprX, sprY, alpha, sheetID); break;
+            case 3: DrawSubtractiveBlendedSprite(x, y, w, h, sprX, sprY, alpha, sheetID); break;
+        }
+    }
+}
+
+void RenderCheckShapes(int sheetID)
+{
+    for (int i = 0; i < 16; ++i) {
+        int x = (i * 53) % GFX_LINESIZE - 24;
+        int y = (i * 37) % SCREEN_YSIZE - 24;
+        switch (i % 3) {
+            case 0: DrawRectangle(x, y, 96, 64, i * 0x10, 0xFF - i * 0x10, 0x80, (i * 0x25) & 0x1FF); break;
+            case 1: DrawTintRectangle(x, y, 96, 64); break;
+            case 2: DrawClassicFade(x, y, 96, 64, 0xFF, i * 0x10, 0x40, (i * 0x25) & 0x1FF); break;
+        }
+    }
+}
+
+void RenderCheckHScrollLayers(int sheetID)
+{
+    // the sparse layer over the solid one, so the occlusion pass has something to skip. both are below the mid point, so both draw the
+    // benchmark chunks' (low) plane
+    stageLayouts[1].type = LAYER_HSCROLL;
+    activeTileLayers[1]  = 2;
+    tLayerMidPoint       = 2;
+    xScrollOffset        = 37;
+    yScrollOffset        = 91;
+    PrepareLayerOcclusion();
+    DrawHLineScrollLayer(0);
+    DrawHLineScrollLayer(1);
+    activeTileLayers[1]   = LAYER_COUNT;
+    tLayerMidPoint        = 1;
+    layerOcclusion.active = false;
+}
+
+void RenderCheckScriptedHScrollLayers(int sheetID)
+{
+    // the same layers with an object in the draw list between them whose draw script retiles & moves the top one after the bottom one's
+    // been drawn, so the occluded frame only matches if the bottom layer didn't trust where the top one was going to be
+    DrawListEntry *drawList = &drawListEntries[1];
+    int entityRef           = ENTITY_COUNT - 1;
+    int type                = OBJECT_COUNT - 1;
+    int scriptCodePtr       = SCRIPTDATA_COUNT - 1;
+    int listSizeStore       = drawList->listSize;
+    int entityRefStore      = drawList->entityRefs[0];
+    byte typeStore          = objectEntityList[entityRef].type;
+    int scriptCodePtrStore  = objectScriptList[type].eventDraw.scriptCodePtr;
+    int scriptDataStore     = scriptData[scriptCodePtr];
+
+    drawList->listSize                             = 1;
+    drawList->entityRefs[0]                        = entityRef;
+    objectEntityList[entityRef].type               = type;
+    objectScriptList[type].eventDraw.scriptCodePtr = scriptCodePtr;
+    scriptData[scriptCodePtr]                      = 1;
+
+    stageLayouts[1].type = LAYER_HSCROLL;
+    activeTileLayers[1]  = 2;
+    tLayerMidPoint       = 2;
+    xScrollOffset        = 37;
+    yScrollOffset        = 91;
+    PrepareLayerOcclusion();
+    DrawHLineScrollLayer(0);
+
+    // what the draw script does
+    TileLayer *layer = &stageLayouts[2];
+    ushort tileStore[0x10][0x10];
+    int scrollPosStore = layer->scrollPos;
+    for (int y = 0; y < 0x10; ++y) {
+        for (int x = 0; x < 0x10; ++x) {
+            tileStore[y][x]            = layer->tiles[x + (y << 8)];
+            layer->tiles[x + (y << 8)] = (tileStore[y][x] + 3) % (CHUNKTILE_COUNT >> 6);
+        }
+    }
+    layer->scrollPos += 0x28 << 16;
+
+    DrawHLineScrollLayer(1);
+
+    for (int y = 0; y < 0x10; ++y) {
+        for (int x = 0; x < 0x10; ++x) layer->tiles[x + (y << 8)] = tileStore[y][x];
+    }
+    layer->scrollPos      = scrollPosStore;
+    activeTileLayers[1]   = LAYER_COUNT;
+    tLayerMidPoint        = 1;
+    layerOcclusion.active = false;
+
+    drawList->listSize                             = listSizeStore;
+    drawList->entityRefs[0]                        = entityRefStore;
+    objectEntityList[entityRef].type               = typeStore;
+    objectScriptList[type].eventDraw.scriptCodePtr = scriptCodePtrStore;
+    scriptData[scriptCodePtr]                      = scriptDataStore;
+}
+
+void RenderCheckVScrollLayer(int sheetID)
+{
+    stageLayouts[1].type = LAYER_VSCROLL;
+    xScrollOffset        = 37;
+    yScrollOffset        = 91;
+    DrawVLineScrollLayer(0);
+    stageLayouts[1].type = LAYER_HSCROLL;
+}
+
+void RenderCheck3DLayer(int sheetID, byte type)
+{
+    TileLayer *layer    = &stageLayouts[3];
+    layer->type         = type;
+    layer->angle        = 0x30;
+    layer->xpos         = 0x400000;
+    layer->ypos         = 0x2000000;
+    layer->zpos         = 0x400000;
+    activeTileLayers[0] = 3;
+    if (type == LAYER_3DFLOOR)
+        Draw3DFloorLayer(0);
+    else
+        Draw3DSkyLayer(0);
+    activeTileLayers[0] = 1;
+}
+
+void RenderCheck3DFloor(int sheetID) { RenderCheck3DLayer(sheetID, LAYER_3DFLOOR); }
+
+void RenderCheck3DSky(int sheetID) { RenderCheck3DLayer(sheetID, LAYER_3DSKY); }
+
+void RenderCheckFaces(int sheetID)
+{
+    Vertex quad[4];
+    for (int i = 0; i < 24; ++i) {
+        GetRenderCheckQuad(i, quad);
+        uint color = ((i * 0x25) & 0x7F) << 24 | (uint)(i + 1) * 0x9E3779 & 0xFFFFFF;
+        switch (i % 4) {
+            case 0: DrawFace(quad, color); break;
+            case 1: DrawFadedFace(quad, color, 0x204060, (i * 0x25) & 0x1FF); break;
+            case 2: DrawTexturedFace(quad, sheetID); break;
+            case 3: DrawTexturedFaceBlended(quad, sheetID); break;
+        }
+    }
+}
+
+void RenderCheck3DScene(int sheetID)
+{
+    // a special stage style floor of quads under a tilted camera, with billboards stood on it. the far rows run off the sides of the
+    // screen and the near ones go behind the camera
+    const int gridSize = 16;
+    vertexCount        = 0;
+    faceCount          = 0;
+    for (int z = 0; z < gridSize; ++z) {
+        for (int x = 0; x < gridSize; ++x) {
+            Vertex *vert = &vertexBuffer[vertexCount++];
+            vert->x      = (x - gridSize / 2) * 0x80;
+            vert->y      = 0;
+            vert->z      = (z - gridSize / 2) * 0x80;
+            vert->u      = x * 0x10;
+            vert->v      = z * 0x10;
+        }
+    }
+    for (int z = 0; z < gridSize - 1; ++z) {
+        for (int x = 0; x < gridSize - 1; ++x) {
+            Face *face  = &faceBuffer[faceCount];
+            face->a     = x + z * gridSize;
+            face->b     = face->a + 1;
+            face->c     = face->a + gridSize;
+            face->d     = face->c + 1;
+            face->color = 0x60000000 | (uint)(faceCount + 1) * 0x9E3779 & 0xFFFFFF;
+            face->flag  = faceCount % 7 == 3 ? FACE_FLAG_COLORED_3D : faceCount % 5 == 1 ? FACE_FLAG_FADED : FACE_FLAG_TEXTURED_3D;
+            faceCount++;
+        }
+    }
+    for (int i = 0; i < 8; ++i) {
+        // billboards: a is the position & sprite centre, b.uv the half size on screen, c.uv the extent on the sheet
+        int base = vertexCount;
+        MEM_ZERO(vertexBuffer[base]);
+        MEM_ZERO(vertexBuffer[base + 1]);
+        MEM_ZERO(vertexBuffer[base + 2]);
+        vertexBuffer[base].x     = (i * 0x95) % 0x600 - 0x300;
+        vertexBuffer[base].y     = 0x40;
+        vertexBuffer[base].z     = (i * 0xE3) % 0x700 - 0x300;
+        vertexBuffer[base].u     = 0x40 + i * 0x10;
+        vertexBuffer[base].v     = 0x40 + i * 0x08;
+        vertexBuffer[base + 1].u = 0x20 + i * 4;
+        vertexBuffer[base + 1].v = 0x30;
+        vertexBuffer[base + 2].u = 0x18;
+        vertexBuffer[base + 2].v = 0x20;
+        vertexCount += 3;
+
+        Face *face = &faceBuffer[faceCount++];
+        face->a    = base;
+        face->b    = base + 1;
+        face->c    = base + 2;
+        face->d    = base;
+        face->flag = i & 1 ? FACE_FLAG_TEXTURED_C_BLEND : FACE_FLAG_TEXTURED_C;
+    }
+
+    MatrixRotateY(&matWorld, 0x18);
+    MatrixTranslateXYZ(&matView, 0, -0x100, 0x300);
+    MatrixRotateX(&matTemp, 0x1E0);
+    MatrixMultiply(&matView, &matTemp);
+    fogColor    = 0x204060;
+    fogStrength = 0xA0;
+
+    TransformVertexBuffer();
+    Sort3DDrawList();
+    Draw3DScene(sheetID);
+}
+
+void RenderCheckFades(int sheetID)
+{
+    // a palette blend over the bottom half, then both kinds of screen fade
+#if !RETRO_REV00
+    SetPaletteFade(2, 0, 1, 0x60, 0, 0xFF);
+    SetActivePalette(2, SCREEN_YSIZE / 2, SCREEN_YSIZE);
+#endif
+    xScrollOffset = 37;
+    yScrollOffset = 91;
+    DrawHLineScrollLayer(0);
+    RenderCheckSprites(sheetID);
+    DrawRectangle(0, 0, SCREEN_XSIZE, SCREEN_YSIZE, 0x00, 0x00, 0x00, 0x80);
+    DrawClassicFade(0, 0, SCREEN_XSIZE, SCREEN_YSIZE, 0xFF, 0xFF, 0xFF, 0x60);
+}
+
+void RenderCheckHQ(int sheetID)
+{
+    // the sky goes to the 2x buffer, with whatever's drawn on top of its half of the screen copied over it
+    drawStageGFXHQ = true;
+    RenderCheck3DLayer(sheetID, LAYER_3DSKY);
+    RenderCheckSprites(sheetID);
+    CopyFrameOverlay2x();
+    SetFadeHQ(0x00, 0x00, 0x00, 0x40);
+    drawStageGFXHQ = false;
+}
+
+struct RenderCheckScene {
+    const char *name;
+    void (*draw)(int sheetID);
+};
+
+struct RenderCheckConfig {
+    const char *name;
+    bool useSIMD;
+    bool useTileCache;
+    bool useLayerOcclusion;
+    bool useSpriteSpans;
+    int renderThreads;
+};
+
+// the plain frames' hashes at the default screen sizes (a 16:9 & a 4:3 window), from the last known good build
+// a change that's meant to alter what a scene draws has to update these along with it
+struct RenderCheckGolden {
+    int screenWidth;
+    int lineSize;
+    const char *name;
+    uint hash;
+};
+
+RenderCheckGolden renderCheckGoldens[] = {
+#if RETRO_REV02
+    { 426, 432, "sprites", 0x84CF1292 },
+    { 426, 432, "transformed", 0xB8AD0C98 },
+    { 426, 432, "blended", 0xDD0B1E08 },
+    { 426, 432, "shapes", 0x79B0DE7F },
+    { 426, 432, "hscroll", 0x50E9B2C2 },
+    { 426, 432, "scriptlayers", 0x6CD2581F },
+    { 426, 432, "vscroll", 0x4DA6E36B },
+    { 426, 432, "3dfloor", 0xF2521D0A },
+    { 426, 432, "3dsky", 0xA9772B01 },
+    { 426, 432, "faces", 0xD75F2FA8 },
+    { 426, 432, "3dscene", 0xF8BEE574 },
+    { 426, 432, "fades", 0x1FF08310 },
+    { 426, 432, "hq", 0x5753B3D4 },
+    { 320, 328, "sprites", 0x0ECD7431 },
+    { 320, 328, "transformed", 0x2215496F },
+    { 320, 328, "blended", 0xB7FC8705 },
+    { 320, 328, "shapes", 0x3D66D4AC },
+    { 320, 328, "hscroll", 0xFF6AF15A },
+    { 320, 328, "scriptlayers", 0x75FFAA59 },
+    { 320, 328, "vscroll", 0x9546C174 },
+    { 320, 328, "3dfloor", 0xC40FC81C },
+    { 320, 328, "3dsky", 0xAF6EA0AF },
+    { 320, 328, "faces", 0x58C9B069 },
+    { 320, 328, "3dscene", 0x9B029C01 },
+    { 320, 328, "fades", 0x02946555 },
+    { 320, 328, "hq", 0x8CED4E13 },
+#endif
+    { 0, 0, NULL, 0 },
+};
+
+inline uint HashRenderCheckBuffer(uint hash, const ushort *buffer, int count)
+{
+    // FNV-1a
+    for (int i = 0; i < count; ++i) {
+        hash = (hash ^ (buffer[i] & 0xFF)) * 0x01000193;
+        hash = (hash ^ (buffer[i] >> 8)) * 0x01000193;
+    }
+    return hash;
+}
+
+inline uint RunRenderCheckScene(RenderCheckScene *scene, int sheetID, double *time)
+{
+    for (int i = 0; i < GFX_LINESIZE * SCREEN_YSIZE; ++i) Engine.frameBuffer[i] = (ushort)(i * 0x9E37);
+    for (int i = 0; i < GFX_LINESIZE_DOUBLE * SCREEN_YSIZE * 2; ++i) Engine.frameBuffer2x[i] = (ushort)(i * 0x7F4B);
+    SetActivePalette(0, 0, SCREEN_YSIZE / 2);
+    SetActivePalette(1, SCREEN_YSIZE / 2, SCREEN_YSIZE);
+
+    unsigned long long start = SDL_GetPerformanceCounter();
+    scene->draw(sheetID);
+    *time += (SDL_GetPerformanceCounter() - start) / ((double)SDL_GetPerformanceFrequency() / 1000.0);
+
+    uint hash = HashRenderCheckBuffer(0x811C9DC5, Engine.frameBuffer, GFX_LINESIZE * SCREEN_YSIZE);
+    return HashRenderCheckBuffer(hash, Engine.frameBuffer2x, GFX_LINESIZE_DOUBLE * SCREEN_YSIZE * 2);
+}
+#endif
+
+void BenchmarkRenderScenes()
+{
+#if RETRO_SOFTWARE_RENDER
+    // draws a fixed set of made up scenes through the real drawing functions with every fast path off, then on, then on & threaded,
+    // checking the frames all match and timing each one. the plain frames are also checked against renderCheckGoldens at the default
+    // screen sizes, or against renderchecks.txt at any other, which gets written instead if it isn't there
+    RenderCheckScene scenes[] = {
+        { "sprites", RenderCheckSprites },
+        { "transformed", RenderCheckTransformedSprites },
+        { "blended", RenderCheckBlendedSprites },
+        { "shapes", RenderCheckShapes },
+        { "hscroll", RenderCheckHScrollLayers },
+        { "scriptlayers", RenderCheckScriptedHScrollLayers },
+        { "vscroll", RenderCheckVScrollLayer },
+        { "3dfloor", RenderCheck3DFloor },
+        { "3dsky", RenderCheck3DSky },
+        { "faces", RenderCheckFaces },
+        { "3dscene", RenderCheck3DScene },
+        { "fades", RenderCheckFades },
+        { "hq", RenderCheckHQ },
+    };
+    RenderCheckConfig configs[] = {
+        { "plain", false, false, false, false, 1 },
+        { "fast", true, true, true, true, 1 },
+        { "threaded", true, false, true, true, Engine.renderThreads > 1 ? Engine.renderThreads : 4 },
+    };
+    const int sceneCount  = sizeof(scenes) / sizeof(RenderCheckScene);
+    const int configCount = sizeof(configs) / sizeof(RenderCheckConfig);
+    const int passCount   = 32;
+
+    BenchmarkStage *stage = new BenchmarkStage;
+    SetupBenchmarkStage(stage);
+    if (stage->sheetID < 0) {
+        PrintLog("Render checks: no room for the sprite sheet, skipping");
+        RestoreBenchmarkStage(stage);
+        delete stage;
+        return;
+    }
+
+    bool useSIMD           = Engine.useSIMD;
+    bool useTileCache      = Engine.useTileCache;
+    bool useLayerOcclusion = Engine.useLayerOcclusion;
+    bool useSpriteSpans    = Engine.useSpriteSpans;
+    Engine.useSpriteSpans  = true;
+    BuildSurfaceSpans(stage->sheetID);
+
+    uint hashes[sizeof(scenes) / sizeof(RenderCheckScene)][sizeof(configs) / sizeof(RenderCheckConfig)];
+    double time[sizeof(scenes) / sizeof(RenderCheckScene)][sizeof(configs) / sizeof(RenderCheckConfig)];
+    for (int c = 0; c < configCount; ++c) {
+        RenderCheckConfig *config = &configs[c];
+        SetBlendKernels(config->useSIMD);
+        Engine.useSIMD           = config->useSIMD;
+        Engine.useTileCache      = config->useTileCache;
+        Engine.useLayerOcclusion = config->useLayerOcclusion;
+        Engine.useSpriteSpans    = config->useSpriteSpans;
+        if (renderThreadCount != config->renderThreads)
+            InitRenderThreads(config->renderThreads);
+        ResetTileCache();
+
+        for (int s = 0; s < sceneCount; ++s) {
+            // only the drawing is timed, not the buffer setup & hashing around it
+            double sceneTime = 0.0;
+            hashes[s][c]     = RunRenderCheckScene(&scenes[s], stage->sheetID, &sceneTime);
+
+            sceneTime = 0.0;
+            for (int p = 0; p < passCount; ++p) RunRenderCheckScene(&scenes[s], stage->sheetID, &sceneTime);
+            time[s][c] = sceneTime / passCount;
+        }
+    }
+
+    // compare against (or record) the hashes from the last known good build
+    char screenSize[0x40];
+    sprintf(screenSize, "%dx%d, line size %d", SCREEN_XSIZE, SCREEN_YSIZE, GFX_LINESIZE);
+    bool useGoldens = false;
+    for (RenderCheckGolden *golden = renderCheckGoldens; golden->name; ++golden) {
+        if (golden->screenWidth == SCREEN_XSIZE && golden->lineSize == GFX_LINESIZE)
+            useGoldens = true;
+    }
+
+    char pathBuffer[0x100];
+    sprintf(pathBuffer, BASE_PATH "renderchecks.txt");
+    char recorded[0x800];
+    int recordedSize = 0;
+    if (!useGoldens) {
+        FileIO *file = fOpen(pathBuffer, "rb");
+        if (file) {
+            recordedSize = (int)fRead(recorded, 1, sizeof(recorded) - 1, file);
+            fClose(file);
+        }
+    }
+    recorded[recordedSize] = 0;
+
+    // a file from another screen size is left alone, it can't be checked against & may be the only record of that size
+    int recordedSizeLength = (int)strcspn(recorded, "\n");
+    bool wrongSize = recordedSize > 0 && (recordedSizeLength != StrLength(screenSize) || strncmp(recorded, screenSize, recordedSizeLength));
+    if (wrongSize) {
+        PrintLog("Render checks: FAILED, %s was taken at %.*s but the screen is %s, delete it to take new ones at this size", pathBuffer,
+                 recordedSizeLength, recorded, screenSize);
+    }
+
+    int mismatches  = 0;
+    int regressions = 0;
+    for (int s = 0; s < sceneCount; ++s) {
+        char status[0x40];
+        StrCopy(status, "ok");
+        for (int c = 1; c < configCount; ++c) {
+            if (hashes[s][c] != hashes[s][0]) {
+                sprintf(status, "%s differs", configs[c].name);
+                mismatches++;
+                break;
+            }
+        }
+
+        bool hasRecord    = false;
+        uint recordedHash = 0;
+        if (useGoldens) {
+            for (RenderCheckGolden *golden = renderCheckGoldens; golden->name; ++golden) {
+                if (golden->screenWidth == SCREEN_XSIZE && golden->lineSize == GFX_LINESIZE && StrComp(golden->name, scenes[s].name)) {
+                    recordedHash = golden->hash;
+                    hasRecord    = true;
+                }
+            }
+        }
+        else if (recordedSize > 0 && !wrongSize) {
+            char key[0x20];
+            sprintf(key, "\n%s ", scenes[s].name);
+            char *entry = strstr(recorded, key);
+            hasRecord   = entry && sscanf(entry + strlen(key), "%X", &recordedHash) == 1;
+        }
+
+        if ((useGoldens || (recordedSize > 0 && !wrongSize)) && !hasRecord) {
+            StrAdd(status, ", not recorded");
+        }
+        else if (hasRecord && recordedHash != hashes[s][0]) {
+            sprintf(status + strlen(status), ", recorded %08X", recordedHash);
+            regressions++;
+        }
+
+        PrintLog("Render check: %-12s %08X  plain %.4fms, fast %.4fms, threaded %.4fms  %s", scenes[s].name, hashes[s][0], time[s][0], time[s][1],
+                 time[s][2], status);
+    }
+    PrintLog("Render checks: %d scenes at %s, %d fast path mismatches, %d changed since %s", sceneCount, screenSize, mismatches, regressions,
+             useGoldens ? "the recorded hashes" : "renderchecks.txt");
+    if (mismatches || regressions || wrongSize)
+        PrintLog("Render checks: FAILED");
+
+    if (!useGoldens && !recordedSize) {
+        FileIO *file = fOpen(pathBuffer, "wb");
+        if (file) {
+            char line[0x40];
+            sprintf(line, "%s\n", screenSize);
+            fWrite(line, 1, strlen(line), file);
+            for (int s = 0; s < sceneCount; ++s) {
+                sprintf(line, "%s %08X\n", scenes[s].name, hashes[s][0]);
+                fWrite(line, 1, strlen(line), file);
+            }
+            fClose(file);
+            PrintLog("Render checks: recorded %s", pathBuffer);
+        }
+    }
+
+    SetBlendKernels(useSIMD);
+    Engine.useSIMD           = useSIMD;
+    Engine.useTileCache      = useTileCache;
+    Engine.useLayerOcclusion = useLayerOcclusion;
+    Engine.useSpriteSpans    = useSpriteSpans;
+    if (renderThreadCount != Engine.renderThreads)
+        InitRenderThreads(Engine.renderThreads);
+    RestoreBenchmarkStage(stage);
+    delete stage;
+#endif
+}
+
+#endif
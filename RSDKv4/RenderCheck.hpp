@@ -0,0 +1,49 @@
+#ifndef RENDERCHECK_H
+#define RENDERCHECK_H
+
+#if !RETRO_USE_ORIGINAL_CODE
+#if RETRO_SOFTWARE_RENDER
+// Everything the made up benchmark scenes overwrite, so they can run before the first stage loads and leave no trace
+struct BenchmarkStage {
+    TileLayer layers[3];
+    Tiles128x128 tiles;
+    byte tileset[TILESET_SIZE];
+    ushort floorBuffer[0x100 * 0x100];
+    ushort palette[PALETTE_COUNT][PALETTE_COLOR_COUNT];
+    PaletteEntry palette32[PALETTE_COUNT][PALETTE_COLOR_COUNT];
+    byte lineBuffer[SCREEN_YSIZE];
+    ushort *activePalette;
+    PaletteEntry *activePalette32;
+    LineScroll hParallax;
+    LineScroll vParallax;
+    byte activeLayers[4];
+    byte midPoint;
+    bool occlusion;
+    bool stageHQ;
+    int xScroll;
+    int yScroll;
+    int xSize;
+    int ySize;
+    // the 3D scene is built over whatever the scripts left in the 3D buffers
+    Vertex vertices[VERTEXBUFFER_SIZE];
+    Face faces[FACEBUFFER_SIZE];
+    int vertexCount;
+    int faceCount;
+    Matrix matWorld;
+    Matrix matView;
+    int fogColor;
+    int fogStrength;
+    // the made up sprite sheet, or -1 if there was no room for it
+    int sheetID;
+};
+
+#define BENCHMARK_SHEET_SIZE (0x100)
+
+void SetupBenchmarkStage(BenchmarkStage *stage);
+void RestoreBenchmarkStage(BenchmarkStage *stage);
+#endif
+
+void BenchmarkRenderScenes();
+#endif
+
+#endif //! RENDERCHECK_H
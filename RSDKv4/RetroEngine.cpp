@@ -294,6 +294,7 @@ void RetroEngine::Init()
 
 #if !RETRO_USE_ORIGINAL_CODE
     InitUserdata();
+    SetBlendKernels(Engine.useSIMD);
 #if RETRO_USE_MOD_LOADER
     InitMods();
 #endif
@@ -348,6 +349,25 @@ void RetroEngine::Init()
 
     if (LoadGameConfig("Data/Game/GameConfig.bin")) {
         if (InitRenderDevice()) {
+#if !RETRO_USE_ORIGINAL_CODE
+            if (Engine.runBenchmarks) {
+                // benchmarks log through PrintLog, so debug mode's only on for as long as they run
+                bool debugMode  = engineDebugMode;
+                engineDebugMode = true;
+                BenchmarkBlendKernels();
+                BenchmarkFrameKernels();
+                BenchmarkScrollLayers();
+                BenchmarkSpriteSpans();
+                BenchmarkRenderScenes();
+                BenchmarkSort3DDrawList();
+                BenchmarkTransformVertexBuffer();
+                BenchmarkProjectVertexBuffer();
+                BenchmarkStageTransition();
+                BenchmarkFileIndex();
+                BenchmarkDecryption();
+                engineDebugMode = debugMode;
+            }
+#endif
             if (InitAudioPlayback()) {
                 InitFirstStage();
                 ClearScriptData();
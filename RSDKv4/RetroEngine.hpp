@@ -190,6 +190,21 @@ typedef unsigned int uint;
 
 #define RETRO_USE_HAPTICS (1)
 
+// SIMD paths for the software renderer's inner loops, the scalar versions are always kept as a fallback
+#if !RETRO_USE_ORIGINAL_CODE && (defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2))
+#define RETRO_USING_SSE2 (1)
+#define RETRO_USING_NEON (0)
+#include <emmintrin.h>
+#elif !RETRO_USE_ORIGINAL_CODE && (defined __ARM_NEON || defined __ARM_NEON__)
+#define RETRO_USING_SSE2 (0)
+#define RETRO_USING_NEON (1)
+#include <arm_neon.h>
+#else
+#define RETRO_USING_SSE2 (0)
+#define RETRO_USING_NEON (0)
+#endif
+#define RETRO_USING_SIMD (RETRO_USING_SSE2 || RETRO_USING_NEON)
+
 // NOTE: This is only used for rev00 stuff, it was removed in rev01 and later builds
 #if RETRO_PLATFORM <= RETRO_WP7
 #define RETRO_GAMEPLATFORMID (RETRO_PLATFORM)
@@ -333,6 +348,7 @@ extern bool engineDebugMode;
 #include "Debug.hpp"
 #include "ModAPI.hpp"
 #include "Video.hpp"
+#include "RenderCheck.hpp"
 
 // Native Entities
 #if RETRO_PLATFORM == RETRO_UWP
@@ -416,6 +432,14 @@ public:
 
     bool showPaletteOverlay = false;
     bool useHQModes         = true;
+    bool useSIMD            = true;
+    bool useTileCache       = false;
+    bool useLayerOcclusion  = false;
+    bool useSpriteSpans     = false;
+    int renderThreads       = 1;
+    int sheetCacheSize      = 0x4000; // in KB
+    bool bakeSheets         = false;
+    bool runBenchmarks      = false;
 
     bool hasFocus  = true;
     int focusState = 0;
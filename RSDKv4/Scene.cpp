@@ -78,6 +78,9 @@ Tiles128x128 tiles128x128;
 CollisionMasks collisionMasks[2];
 
 byte tilesetGFXData[TILESET_SIZE];
+#if !RETRO_USE_ORIGINAL_CODE
+ushort tileRowOpacity[TILE_COUNT];
+#endif
 
 ushort tile3DFloorBuffer[0x100 * 0x100];
 bool drawStageGFXHQ = false;
@@ -607,7 +610,11 @@ void LoadStageFiles(void)
         PrintLog("Loading Scene %s - %s", stageListNames[activeStageList], stageList[activeStageList][stageListPosition].name);
         ReleaseStageSfx();
         ClearScriptData();
+#if RETRO_USE_ORIGINAL_CODE
         for (int i = SURFACE_COUNT; i > 0; i--) RemoveGraphicsFile((char *)"", i - 1);
+#else
+        for (int i = SURFACE_COUNT; i > 0; i--) DemoteGraphicsFile(i - 1);
+#endif
 
 #if RETRO_USE_MOD_LOADER
         loadGlobalScripts = false;
@@ -838,6 +845,11 @@ void LoadStageFiles(void)
     LoadActLayout();
     Init3DFloorBuffer(0);
     ProcessStartupObjects();
+#if !RETRO_USE_ORIGINAL_CODE
+    ReportSheetCache();
+    ReportGifDecoding();
+    ReportFileAccess();
+#endif
 }
 int LoadActFile(const char *ext, int stageID, FileInfo *info)
 {
@@ -1375,6 +1387,12 @@ void LoadStageGIFFile(int stageID)
                 tilesetGFXData[i] = 0;
         }
 
+#if !RETRO_USE_ORIGINAL_CODE
+        for (int t = 0; t < TILE_COUNT; ++t) UpdateTileOpacity(t);
+        ResetTileCache();
+        layerOcclusion.failed = false;
+#endif
+
         CloseFile();
     }
 }
@@ -209,6 +209,10 @@ extern Tiles128x128 tiles128x128;
 extern CollisionMasks collisionMasks[2];
 
 extern byte tilesetGFXData[TILESET_SIZE];
+#if !RETRO_USE_ORIGINAL_CODE
+// one bit per tile row, set if every pixel in that row is solid
+extern ushort tileRowOpacity[TILE_COUNT];
+#endif
 
 extern ushort tile3DFloorBuffer[0x100 * 0x100];
 extern bool drawStageGFXHQ;
@@ -253,12 +257,35 @@ inline void Init3DFloorBuffer(int layerID)
     }
 }
 
+#if !RETRO_USE_ORIGINAL_CODE
+inline void UpdateTileOpacity(int tileID)
+{
+    byte *gfxData = &tilesetGFXData[tileID * TILE_DATASIZE];
+    ushort mask   = 0;
+    for (int y = 0; y < TILE_SIZE; ++y) {
+        int x = 0;
+        while (x < TILE_SIZE && gfxData[x] > 0) ++x;
+        if (x == TILE_SIZE)
+            mask |= 1 << y;
+        gfxData += TILE_SIZE;
+    }
+    tileRowOpacity[tileID] = mask;
+}
+#endif
+
 inline void Copy16x16Tile(ushort dest, ushort src)
 {
     byte *destPtr = &tilesetGFXData[TILELAYER_CHUNK_W * dest];
     byte *srcPtr  = &tilesetGFXData[TILELAYER_CHUNK_W * src];
     int cnt       = TILE_DATASIZE;
     while (cnt--) *destPtr++ = *srcPtr++;
+
+#if !RETRO_USE_ORIGINAL_CODE
+    if (dest < TILE_COUNT) {
+        UpdateTileOpacity(dest);
+        InvalidateTileCache(dest);
+    }
+#endif
 }
 
 void SetLayerDeformation(int selectedDef, int waveLength, int waveWidth, int waveType, int YPos, int waveSize);
@@ -13,6 +13,9 @@ Vertex vertexBuffer[VERTEXBUFFER_SIZE];
 Vertex vertexBufferT[VERTEXBUFFER_SIZE];
 
 DrawListEntry3D drawList3D[FACEBUFFER_SIZE];
+#if !RETRO_USE_ORIGINAL_CODE
+ProjectedVertex vertexBufferP[VERTEXBUFFER_SIZE];
+#endif
 
 int projectionX = 136;
 int projectionY = 160;
@@ -26,6 +29,55 @@ int faceLineEndU[SCREEN_YSIZE];
 int faceLineStartV[SCREEN_YSIZE];
 int faceLineEndV[SCREEN_YSIZE];
 
+#if RETRO_USING_SSE2
+#include <smmintrin.h>
+#if defined _MSC_VER
+#include <intrin.h>
+#endif
+
+// SSE4.1 kernels are built for it whatever the build targets, & only run when the CPU reports it
+#if defined __GNUC__ || defined __clang__
+#define RETRO_TARGET_SSE41 __attribute__((target("sse4.1")))
+#else
+#define RETRO_TARGET_SSE41
+#endif
+
+static bool CheckSSE41Support()
+{
+#if defined __SSE4_1__
+    return true;
+#elif defined __GNUC__ || defined __clang__
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.1");
+#elif defined _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] >> 19) & 1;
+#else
+    return false;
+#endif
+}
+
+static const bool cpuHasSSE41 = CheckSSE41Support();
+
+// 32-bit multiply-low, SSE4.1 has one and plain SSE2 builds it from the two 32x32->64 multiplies
+static inline __m128i MultiplyLow32(__m128i a, __m128i b)
+{
+#ifdef __SSE4_1__
+    return _mm_mullo_epi32(a, b);
+#else
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd  = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+}
+
+// the engine's fixed point multiply, (a * b) >> 8 with the same wrap & rounding towards -infinity as the scalar maths
+#define FixedMultiply(a, b) _mm_srai_epi32(MultiplyLow32(a, b), 8)
+#elif RETRO_USING_NEON
+#define FixedMultiply(a, b) vshrq_n_s32(vmulq_s32(a, b), 8)
+#endif
+
 void SetIdentityMatrix(Matrix *matrix)
 {
     matrix->values[0][0] = 0x100;
@@ -48,7 +100,7 @@ void SetIdentityMatrix(Matrix *matrix)
     matrix->values[3][2] = 0;
     matrix->values[3][3] = 0x100;
 }
-void MatrixMultiply(Matrix *matrixA, Matrix *matrixB)
+static void MatrixMultiply_Scalar(Matrix *matrixA, Matrix *matrixB)
 {
     int output[16];
 
@@ -61,6 +113,54 @@ void MatrixMultiply(Matrix *matrixA, Matrix *matrixB)
 
     for (int i = 0; i < 0x10; ++i) matrixA->values[i / 4][i % 4] = output[i];
 }
+
+#if RETRO_USING_SSE2
+// each output row is every row of B scaled by one value of the same row of A, so B's rows are kept in registers
+static void MatrixMultiply_SIMD(Matrix *matrixA, Matrix *matrixB)
+{
+    __m128i rowB0 = _mm_loadu_si128((__m128i *)matrixB->values[0]);
+    __m128i rowB1 = _mm_loadu_si128((__m128i *)matrixB->values[1]);
+    __m128i rowB2 = _mm_loadu_si128((__m128i *)matrixB->values[2]);
+    __m128i rowB3 = _mm_loadu_si128((__m128i *)matrixB->values[3]);
+
+    __m128i output[4];
+    for (int r = 0; r < 4; ++r) {
+        int *rowA = matrixA->values[r];
+        output[r] = _mm_add_epi32(_mm_add_epi32(FixedMultiply(_mm_set1_epi32(rowA[3]), rowB3), FixedMultiply(_mm_set1_epi32(rowA[2]), rowB2)),
+                                  _mm_add_epi32(FixedMultiply(_mm_set1_epi32(rowA[1]), rowB1), FixedMultiply(_mm_set1_epi32(rowA[0]), rowB0)));
+    }
+
+    for (int r = 0; r < 4; ++r) _mm_storeu_si128((__m128i *)matrixA->values[r], output[r]);
+}
+#elif RETRO_USING_NEON
+static void MatrixMultiply_SIMD(Matrix *matrixA, Matrix *matrixB)
+{
+    int32x4_t rowB0 = vld1q_s32(matrixB->values[0]);
+    int32x4_t rowB1 = vld1q_s32(matrixB->values[1]);
+    int32x4_t rowB2 = vld1q_s32(matrixB->values[2]);
+    int32x4_t rowB3 = vld1q_s32(matrixB->values[3]);
+
+    int32x4_t output[4];
+    for (int r = 0; r < 4; ++r) {
+        int *rowA = matrixA->values[r];
+        output[r] = vaddq_s32(vaddq_s32(FixedMultiply(vdupq_n_s32(rowA[3]), rowB3), FixedMultiply(vdupq_n_s32(rowA[2]), rowB2)),
+                              vaddq_s32(FixedMultiply(vdupq_n_s32(rowA[1]), rowB1), FixedMultiply(vdupq_n_s32(rowA[0]), rowB0)));
+    }
+
+    for (int r = 0; r < 4; ++r) vst1q_s32(matrixA->values[r], output[r]);
+}
+#endif
+
+void MatrixMultiply(Matrix *matrixA, Matrix *matrixB)
+{
+#if RETRO_USING_SIMD
+    if (Engine.useSIMD) {
+        MatrixMultiply_SIMD(matrixA, matrixB);
+        return;
+    }
+#endif
+    MatrixMultiply_Scalar(matrixA, matrixB);
+}
 void MatrixTranslateXYZ(Matrix *matrix, int XPos, int YPos, int ZPos)
 {
     matrix->values[0][0] = 0x100;
@@ -262,6 +362,119 @@ void MatrixInverse(Matrix *matrix)
     for (int i = 0; i < 0x10; ++i) matrix->values[i / 4][i % 4] = inv[i];
 }
 #endif
+// src & dst can be the same vertices, each one is read before it's written
+static void TransformVertices_Scalar(Matrix *matrix, Vertex *src, Vertex *dst, int count)
+{
+    for (int v = 0; v < count; ++v) {
+        int vx   = src[v].x;
+        int vy   = src[v].y;
+        int vz   = src[v].z;
+        dst[v].x = (vx * matrix->values[0][0] >> 8) + (vy * matrix->values[1][0] >> 8) + (vz * matrix->values[2][0] >> 8) + matrix->values[3][0];
+        dst[v].y = (vx * matrix->values[0][1] >> 8) + (vy * matrix->values[1][1] >> 8) + (vz * matrix->values[2][1] >> 8) + matrix->values[3][1];
+        dst[v].z = (vx * matrix->values[0][2] >> 8) + (vy * matrix->values[1][2] >> 8) + (vz * matrix->values[2][2] >> 8) + matrix->values[3][2];
+    }
+}
+
+#if RETRO_USING_SSE2
+#define FixedMultiply41(a, b) _mm_srai_epi32(_mm_mullo_epi32(a, b), 8)
+
+// four vertices at a time, one lane each
+RETRO_TARGET_SSE41 static void TransformVertices_SSE41(Matrix *matrix, Vertex *src, Vertex *dst, int count)
+{
+    __m128i m00 = _mm_set1_epi32(matrix->values[0][0]);
+    __m128i m01 = _mm_set1_epi32(matrix->values[0][1]);
+    __m128i m02 = _mm_set1_epi32(matrix->values[0][2]);
+    __m128i m10 = _mm_set1_epi32(matrix->values[1][0]);
+    __m128i m11 = _mm_set1_epi32(matrix->values[1][1]);
+    __m128i m12 = _mm_set1_epi32(matrix->values[1][2]);
+    __m128i m20 = _mm_set1_epi32(matrix->values[2][0]);
+    __m128i m21 = _mm_set1_epi32(matrix->values[2][1]);
+    __m128i m22 = _mm_set1_epi32(matrix->values[2][2]);
+    __m128i m30 = _mm_set1_epi32(matrix->values[3][0]);
+    __m128i m31 = _mm_set1_epi32(matrix->values[3][1]);
+    __m128i m32 = _mm_set1_epi32(matrix->values[3][2]);
+
+    int v = 0;
+    for (; v + 4 <= count; v += 4) {
+        __m128i vx = _mm_setr_epi32(src[v].x, src[v + 1].x, src[v + 2].x, src[v + 3].x);
+        __m128i vy = _mm_setr_epi32(src[v].y, src[v + 1].y, src[v + 2].y, src[v + 3].y);
+        __m128i vz = _mm_setr_epi32(src[v].z, src[v + 1].z, src[v + 2].z, src[v + 3].z);
+
+        __m128i x = _mm_add_epi32(_mm_add_epi32(FixedMultiply41(vx, m00), FixedMultiply41(vy, m10)), _mm_add_epi32(FixedMultiply41(vz, m20), m30));
+        __m128i y = _mm_add_epi32(_mm_add_epi32(FixedMultiply41(vx, m01), FixedMultiply41(vy, m11)), _mm_add_epi32(FixedMultiply41(vz, m21), m31));
+        __m128i z = _mm_add_epi32(_mm_add_epi32(FixedMultiply41(vx, m02), FixedMultiply41(vy, m12)), _mm_add_epi32(FixedMultiply41(vz, m22), m32));
+
+        int xs[4], ys[4], zs[4];
+        _mm_storeu_si128((__m128i *)xs, x);
+        _mm_storeu_si128((__m128i *)ys, y);
+        _mm_storeu_si128((__m128i *)zs, z);
+        for (int i = 0; i < 4; ++i) {
+            dst[v + i].x = xs[i];
+            dst[v + i].y = ys[i];
+            dst[v + i].z = zs[i];
+        }
+    }
+    TransformVertices_Scalar(matrix, &src[v], &dst[v], count - v);
+}
+
+// it needs SSE4.1's multiply-low, plain SSE2's emulated one costs more than the nine imuls per vertex it'd replace
+static void TransformVertices_SIMD(Matrix *matrix, Vertex *src, Vertex *dst, int count)
+{
+    if (cpuHasSSE41)
+        TransformVertices_SSE41(matrix, src, dst, count);
+    else
+        TransformVertices_Scalar(matrix, src, dst, count);
+}
+#elif RETRO_USING_NEON
+// four vertices at a time, one lane each
+static void TransformVertices_SIMD(Matrix *matrix, Vertex *src, Vertex *dst, int count)
+{
+    int32x4_t m00 = vdupq_n_s32(matrix->values[0][0]);
+    int32x4_t m01 = vdupq_n_s32(matrix->values[0][1]);
+    int32x4_t m02 = vdupq_n_s32(matrix->values[0][2]);
+    int32x4_t m10 = vdupq_n_s32(matrix->values[1][0]);
+    int32x4_t m11 = vdupq_n_s32(matrix->values[1][1]);
+    int32x4_t m12 = vdupq_n_s32(matrix->values[1][2]);
+    int32x4_t m20 = vdupq_n_s32(matrix->values[2][0]);
+    int32x4_t m21 = vdupq_n_s32(matrix->values[2][1]);
+    int32x4_t m22 = vdupq_n_s32(matrix->values[2][2]);
+    int32x4_t m30 = vdupq_n_s32(matrix->values[3][0]);
+    int32x4_t m31 = vdupq_n_s32(matrix->values[3][1]);
+    int32x4_t m32 = vdupq_n_s32(matrix->values[3][2]);
+
+    int v = 0;
+    for (; v + 4 <= count; v += 4) {
+        int32x4_t vx = { src[v].x, src[v + 1].x, src[v + 2].x, src[v + 3].x };
+        int32x4_t vy = { src[v].y, src[v + 1].y, src[v + 2].y, src[v + 3].y };
+        int32x4_t vz = { src[v].z, src[v + 1].z, src[v + 2].z, src[v + 3].z };
+
+        int xs[4], ys[4], zs[4];
+        vst1q_s32(xs, vaddq_s32(vaddq_s32(FixedMultiply(vx, m00), FixedMultiply(vy, m10)), vaddq_s32(FixedMultiply(vz, m20), m30)));
+        vst1q_s32(ys, vaddq_s32(vaddq_s32(FixedMultiply(vx, m01), FixedMultiply(vy, m11)), vaddq_s32(FixedMultiply(vz, m21), m31)));
+        vst1q_s32(zs, vaddq_s32(vaddq_s32(FixedMultiply(vx, m02), FixedMultiply(vy, m12)), vaddq_s32(FixedMultiply(vz, m22), m32)));
+        for (int i = 0; i < 4; ++i) {
+            dst[v + i].x = xs[i];
+            dst[v + i].y = ys[i];
+            dst[v + i].z = zs[i];
+        }
+    }
+    TransformVertices_Scalar(matrix, &src[v], &dst[v], count - v);
+}
+#else
+#define TransformVertices_SIMD TransformVertices_Scalar
+#endif
+
+static void TransformVertexRange(Matrix *matrix, Vertex *src, Vertex *dst, int count)
+{
+#if RETRO_USING_SIMD
+    if (Engine.useSIMD) {
+        TransformVertices_SIMD(matrix, src, dst, count);
+        return;
+    }
+#endif
+    TransformVertices_Scalar(matrix, src, dst, count);
+}
+
 void TransformVertexBuffer()
 {
     matFinal.values[0][0] = matWorld.values[0][0];
@@ -285,31 +498,212 @@ void TransformVertexBuffer()
     matFinal.values[3][3] = matWorld.values[3][3];
     MatrixMultiply(&matFinal, &matView);
 
-    for (int v = 0; v < vertexCount; ++v) {
-        int vx = vertexBuffer[v].x;
-        int vy = vertexBuffer[v].y;
-        int vz = vertexBuffer[v].z;
-
-        vertexBufferT[v].x =
-            (vx * matFinal.values[0][0] >> 8) + (vy * matFinal.values[1][0] >> 8) + (vz * matFinal.values[2][0] >> 8) + matFinal.values[3][0];
-        vertexBufferT[v].y =
-            (vx * matFinal.values[0][1] >> 8) + (vy * matFinal.values[1][1] >> 8) + (vz * matFinal.values[2][1] >> 8) + matFinal.values[3][1];
-        vertexBufferT[v].z =
-            (vx * matFinal.values[0][2] >> 8) + (vy * matFinal.values[1][2] >> 8) + (vz * matFinal.values[2][2] >> 8) + matFinal.values[3][2];
-    }
+    TransformVertexRange(&matFinal, vertexBuffer, vertexBufferT, vertexCount);
 }
 void TransformVertices(Matrix *matrix, int startIndex, int endIndex)
+{
+    if (startIndex < endIndex)
+        TransformVertexRange(matrix, &vertexBuffer[startIndex], &vertexBuffer[startIndex], endIndex - startIndex);
+}
+#if !RETRO_USE_ORIGINAL_CODE
+// Every transformed vertex is projected once per frame rather than once per face that uses it
+static void ProjectVertices_Scalar(int startIndex, int endIndex)
 {
     for (int v = startIndex; v < endIndex; ++v) {
-        int vx       = vertexBuffer[v].x;
-        int vy       = vertexBuffer[v].y;
-        int vz       = vertexBuffer[v].z;
-        Vertex *vert = &vertexBuffer[v];
-        vert->x      = (vx * matrix->values[0][0] >> 8) + (vy * matrix->values[1][0] >> 8) + (vz * matrix->values[2][0] >> 8) + matrix->values[3][0];
-        vert->y      = (vx * matrix->values[0][1] >> 8) + (vy * matrix->values[1][1] >> 8) + (vz * matrix->values[2][1] >> 8) + matrix->values[3][1];
-        vert->z      = (vx * matrix->values[0][2] >> 8) + (vy * matrix->values[1][2] >> 8) + (vz * matrix->values[2][2] >> 8) + matrix->values[3][2];
+        Vertex *vert          = &vertexBufferT[v];
+        ProjectedVertex *proj = &vertexBufferP[v];
+        if (vert->z > 0) {
+            proj->x       = SCREEN_CENTERX + projectionX * vert->x / vert->z;
+            proj->y       = SCREEN_CENTERY - projectionY * vert->y / vert->z;
+            proj->outcode = 0;
+            if (proj->x < 0)
+                proj->outcode |= OUTCODE_LEFT;
+            if (proj->x > GFX_LINESIZE)
+                proj->outcode |= OUTCODE_RIGHT;
+            if (proj->y < 0)
+                proj->outcode |= OUTCODE_TOP;
+            if (proj->y > SCREEN_YSIZE)
+                proj->outcode |= OUTCODE_BOTTOM;
+        }
+        else {
+            proj->x       = 0;
+            proj->y       = 0;
+            proj->outcode = OUTCODE_NEAR;
+        }
+    }
+}
+
+#if RETRO_USING_SSE2
+// there's no integer divide either, but any 32-bit quotient is exact in doubles, and truncating it matches C's integer division
+static inline __m128i DivideTrunc32(__m128i num, __m128i den)
+{
+    __m128d lo = _mm_div_pd(_mm_cvtepi32_pd(num), _mm_cvtepi32_pd(den));
+    __m128d hi = _mm_div_pd(_mm_cvtepi32_pd(_mm_srli_si128(num, 8)), _mm_cvtepi32_pd(_mm_srli_si128(den, 8)));
+    return _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+}
+
+static void ProjectVertices_SIMD(int startIndex, int endIndex)
+{
+    __m128i zero    = _mm_setzero_si128();
+    __m128i one     = _mm_set1_epi32(1);
+    __m128i projX   = _mm_set1_epi32(projectionX);
+    __m128i projY   = _mm_set1_epi32(projectionY);
+    __m128i centerX = _mm_set1_epi32(SCREEN_CENTERX);
+    __m128i centerY = _mm_set1_epi32(SCREEN_CENTERY);
+    __m128i right   = _mm_set1_epi32(GFX_LINESIZE);
+    __m128i bottom  = _mm_set1_epi32(SCREEN_YSIZE);
+
+    int v = startIndex;
+    for (; v + 4 <= endIndex; v += 4) {
+        Vertex *vert = &vertexBufferT[v];
+        __m128i vx   = _mm_setr_epi32(vert[0].x, vert[1].x, vert[2].x, vert[3].x);
+        __m128i vy   = _mm_setr_epi32(vert[0].y, vert[1].y, vert[2].y, vert[3].y);
+        __m128i vz   = _mm_setr_epi32(vert[0].z, vert[1].z, vert[2].z, vert[3].z);
+
+        // vertices behind the camera divide by 1 and get thrown away, so they can't fault
+        __m128i front = _mm_cmpgt_epi32(vz, zero);
+        vz            = _mm_or_si128(_mm_and_si128(front, vz), _mm_andnot_si128(front, one));
+
+        __m128i x = _mm_and_si128(front, _mm_add_epi32(centerX, DivideTrunc32(MultiplyLow32(projX, vx), vz)));
+        __m128i y = _mm_and_si128(front, _mm_sub_epi32(centerY, DivideTrunc32(MultiplyLow32(projY, vy), vz)));
+
+        __m128i codes = _mm_and_si128(_mm_cmplt_epi32(x, zero), _mm_set1_epi32(OUTCODE_LEFT));
+        codes         = _mm_or_si128(codes, _mm_and_si128(_mm_cmpgt_epi32(x, right), _mm_set1_epi32(OUTCODE_RIGHT)));
+        codes         = _mm_or_si128(codes, _mm_and_si128(_mm_cmplt_epi32(y, zero), _mm_set1_epi32(OUTCODE_TOP)));
+        codes         = _mm_or_si128(codes, _mm_and_si128(_mm_cmpgt_epi32(y, bottom), _mm_set1_epi32(OUTCODE_BOTTOM)));
+        codes         = _mm_or_si128(_mm_and_si128(front, codes), _mm_andnot_si128(front, _mm_set1_epi32(OUTCODE_NEAR)));
+
+        int xs[4], ys[4], outcodes[4];
+        _mm_storeu_si128((__m128i *)xs, x);
+        _mm_storeu_si128((__m128i *)ys, y);
+        _mm_storeu_si128((__m128i *)outcodes, codes);
+        for (int i = 0; i < 4; ++i) {
+            vertexBufferP[v + i].x       = xs[i];
+            vertexBufferP[v + i].y       = ys[i];
+            vertexBufferP[v + i].outcode = outcodes[i];
+        }
     }
+    ProjectVertices_Scalar(v, endIndex);
+}
+#elif RETRO_USING_NEON && defined(__aarch64__)
+// NEON only has a vector divide for doubles on AArch64, any 32-bit quotient is exact in those
+static inline int32x4_t DivideTrunc32(int32x4_t num, int32x4_t den)
+{
+    float64x2_t lo = vdivq_f64(vcvtq_f64_s64(vmovl_s32(vget_low_s32(num))), vcvtq_f64_s64(vmovl_s32(vget_low_s32(den))));
+    float64x2_t hi = vdivq_f64(vcvtq_f64_s64(vmovl_high_s32(num)), vcvtq_f64_s64(vmovl_high_s32(den)));
+    return vcombine_s32(vmovn_s64(vcvtq_s64_f64(lo)), vmovn_s64(vcvtq_s64_f64(hi)));
 }
+
+static void ProjectVertices_SIMD(int startIndex, int endIndex)
+{
+    int32x4_t zero    = vdupq_n_s32(0);
+    int32x4_t one     = vdupq_n_s32(1);
+    int32x4_t centerX = vdupq_n_s32(SCREEN_CENTERX);
+    int32x4_t centerY = vdupq_n_s32(SCREEN_CENTERY);
+    int32x4_t right   = vdupq_n_s32(GFX_LINESIZE);
+    int32x4_t bottom  = vdupq_n_s32(SCREEN_YSIZE);
+
+    int v = startIndex;
+    for (; v + 4 <= endIndex; v += 4) {
+        Vertex *vert = &vertexBufferT[v];
+        int32x4_t vx = { vert[0].x, vert[1].x, vert[2].x, vert[3].x };
+        int32x4_t vy = { vert[0].y, vert[1].y, vert[2].y, vert[3].y };
+        int32x4_t vz = { vert[0].z, vert[1].z, vert[2].z, vert[3].z };
+
+        // vertices behind the camera divide by 1 and get thrown away, so they can't fault
+        uint32x4_t front = vcgtq_s32(vz, zero);
+        vz               = vbslq_s32(front, vz, one);
+
+        int32x4_t x = vandq_s32(vreinterpretq_s32_u32(front), vaddq_s32(centerX, DivideTrunc32(vmulq_n_s32(vx, projectionX), vz)));
+        int32x4_t y = vandq_s32(vreinterpretq_s32_u32(front), vsubq_s32(centerY, DivideTrunc32(vmulq_n_s32(vy, projectionY), vz)));
+
+        uint32x4_t codes = vandq_u32(vcltq_s32(x, zero), vdupq_n_u32(OUTCODE_LEFT));
+        codes            = vorrq_u32(codes, vandq_u32(vcgtq_s32(x, right), vdupq_n_u32(OUTCODE_RIGHT)));
+        codes            = vorrq_u32(codes, vandq_u32(vcltq_s32(y, zero), vdupq_n_u32(OUTCODE_TOP)));
+        codes            = vorrq_u32(codes, vandq_u32(vcgtq_s32(y, bottom), vdupq_n_u32(OUTCODE_BOTTOM)));
+        codes            = vbslq_u32(front, codes, vdupq_n_u32(OUTCODE_NEAR));
+
+        int xs[4], ys[4], outcodes[4];
+        vst1q_s32(xs, x);
+        vst1q_s32(ys, y);
+        vst1q_s32(outcodes, vreinterpretq_s32_u32(codes));
+        for (int i = 0; i < 4; ++i) {
+            vertexBufferP[v + i].x       = xs[i];
+            vertexBufferP[v + i].y       = ys[i];
+            vertexBufferP[v + i].outcode = outcodes[i];
+        }
+    }
+    ProjectVertices_Scalar(v, endIndex);
+}
+#else
+#define ProjectVertices_SIMD ProjectVertices_Scalar
+#endif
+
+void ProjectVertexBuffer()
+{
+    if (Engine.useSIMD)
+        ProjectVertices_SIMD(0, vertexCount);
+    else
+        ProjectVertices_Scalar(0, vertexCount);
+}
+
+// the original ordering: a bubble sort that only swaps on a strictly greater depth, so faces with equal depths stay in index order
+static void BubbleSortDrawList(DrawListEntry3D *list, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        for (int j = count - 1; j > i; --j) {
+            if (list[j].depth > list[j - 1].depth) {
+                DrawListEntry3D entry = list[j];
+                list[j]               = list[j - 1];
+                list[j - 1]           = entry;
+            }
+        }
+    }
+}
+
+// LSD radix sort on the depth, 8 bits per pass. each pass is stable so the result matches the bubble sort exactly,
+// and passes where every face shares the same byte (usually the top ones) are skipped
+static void RadixSortDrawList(DrawListEntry3D *list, int count)
+{
+    static DrawListEntry3D sortBuffer[FACEBUFFER_SIZE];
+    int histogram[4][0x100];
+    memset(histogram, 0, sizeof(histogram));
+
+    // flipping every bit but the sign turns "descending signed depth" into "ascending unsigned key"
+    for (int i = 0; i < count; ++i) {
+        uint key = (uint)list[i].depth ^ 0x7FFFFFFF;
+        histogram[0][key & 0xFF]++;
+        histogram[1][(key >> 8) & 0xFF]++;
+        histogram[2][(key >> 16) & 0xFF]++;
+        histogram[3][key >> 24]++;
+    }
+
+    DrawListEntry3D *src = list;
+    DrawListEntry3D *dst = sortBuffer;
+    for (int pass = 0; pass < 4; ++pass) {
+        int shift    = pass * 8;
+        int *offsets = histogram[pass];
+        if (offsets[(((uint)src[0].depth ^ 0x7FFFFFFF) >> shift) & 0xFF] == count)
+            continue;
+
+        int offset = 0;
+        for (int b = 0; b < 0x100; ++b) {
+            int size   = offsets[b];
+            offsets[b] = offset;
+            offset += size;
+        }
+        for (int i = 0; i < count; ++i) dst[offsets[(((uint)src[i].depth ^ 0x7FFFFFFF) >> shift) & 0xFF]++] = src[i];
+
+        DrawListEntry3D *swap = src;
+        src                   = dst;
+        dst                   = swap;
+    }
+
+    if (src != list)
+        memcpy(list, src, count * sizeof(DrawListEntry3D));
+}
+#endif
+
 void Sort3DDrawList()
 {
     for (int i = 0; i < faceCount; ++i) {
@@ -319,6 +713,7 @@ void Sort3DDrawList()
         drawList3D[i].faceID = i;
     }
 
+#if RETRO_USE_ORIGINAL_CODE
     for (int i = 0; i < faceCount; ++i) {
         for (int j = faceCount - 1; j > i; --j) {
             if (drawList3D[j].depth > drawList3D[j - 1].depth) {
@@ -331,9 +726,217 @@ void Sort3DDrawList()
             }
         }
     }
+#else
+    if (faceCount > 1)
+        RadixSortDrawList(drawList3D, faceCount);
+#endif
 }
+
+#if !RETRO_USE_ORIGINAL_CODE
+void BenchmarkSort3DDrawList()
+{
+    // depths are drawn from a narrow range so there are plenty of ties to check the order of
+    const int sizes[]       = { 64, 256, FACEBUFFER_SIZE };
+    DrawListEntry3D *input  = new DrawListEntry3D[FACEBUFFER_SIZE];
+    DrawListEntry3D *bubble = new DrawListEntry3D[FACEBUFFER_SIZE];
+    DrawListEntry3D *radix  = new DrawListEntry3D[FACEBUFFER_SIZE];
+    double freq             = (double)SDL_GetPerformanceFrequency() / 1000.0;
+    uint seed               = 0x1234567;
+
+    for (int s = 0; s < 3; ++s) {
+        int count     = sizes[s];
+        int passCount = 0x10000 / count;
+        for (int i = 0; i < count; ++i) {
+            seed            = seed * 1103515245 + 12345;
+            input[i].depth  = (int)((seed >> 8) % 0x600) * 0x40 - 0x4000;
+            input[i].faceID = i;
+        }
+
+        unsigned long long start = SDL_GetPerformanceCounter();
+        for (int p = 0; p < passCount; ++p) {
+            memcpy(bubble, input, count * sizeof(DrawListEntry3D));
+            BubbleSortDrawList(bubble, count);
+        }
+        double bubbleTime = (SDL_GetPerformanceCounter() - start) / freq / passCount;
+
+        start = SDL_GetPerformanceCounter();
+        for (int p = 0; p < passCount; ++p) {
+            memcpy(radix, input, count * sizeof(DrawListEntry3D));
+            RadixSortDrawList(radix, count);
+        }
+        double radixTime = (SDL_GetPerformanceCounter() - start) / freq / passCount;
+
+        bool match = !memcmp(bubble, radix, count * sizeof(DrawListEntry3D));
+        PrintLog("3D sort benchmark: %4d faces, bubble %.4fms, radix %.4fms (%.2fx), %s", count, bubbleTime, radixTime,
+                 radixTime > 0.0 ? bubbleTime / radixTime : 0.0, match ? "same order" : "ORDER MISMATCH");
+    }
+
+    delete[] input;
+    delete[] bubble;
+    delete[] radix;
+}
+
+void BenchmarkTransformVertexBuffer()
+{
+    // checks the SIMD matrix & vertex maths against the scalar versions on random input, then times a full vertex buffer with each
+    const int passCount = 64;
+    Vertex *saved       = new Vertex[VERTEXBUFFER_SIZE * 2];
+    Vertex *scalar      = new Vertex[VERTEXBUFFER_SIZE];
+    Matrix savedWorld   = matWorld;
+    Matrix savedView    = matView;
+    int savedCount      = vertexCount;
+    bool useSIMD        = Engine.useSIMD;
+    double freq         = (double)SDL_GetPerformanceFrequency() / 1000.0;
+    uint seed           = 0x2468ACE;
+    memcpy(saved, vertexBuffer, VERTEXBUFFER_SIZE * sizeof(Vertex));
+    memcpy(&saved[VERTEXBUFFER_SIZE], vertexBufferT, VERTEXBUFFER_SIZE * sizeof(Vertex));
+
+    int matrixMismatches = 0;
+    for (int m = 0; m < 0x100; ++m) {
+        Matrix a, b;
+        for (int i = 0; i < 0x10; ++i) {
+            seed                   = seed * 1103515245 + 12345;
+            a.values[i / 4][i % 4] = (int)(seed >> 8) % 0x400 - 0x200;
+            seed                   = seed * 1103515245 + 12345;
+            b.values[i / 4][i % 4] = (int)(seed >> 8) % 0x40000 - 0x20000;
+        }
+        Matrix result = a;
+        MatrixMultiply_Scalar(&result, &b);
+#if RETRO_USING_SIMD
+        MatrixMultiply_SIMD(&a, &b);
+#else
+        MatrixMultiply_Scalar(&a, &b);
+#endif
+        if (memcmp(&a, &result, sizeof(Matrix)))
+            matrixMismatches++;
+    }
+
+    vertexCount = VERTEXBUFFER_SIZE;
+    for (int v = 0; v < VERTEXBUFFER_SIZE; ++v) {
+        seed              = seed * 1103515245 + 12345;
+        vertexBuffer[v].x = (int)(seed >> 8) % 0x80000 - 0x40000;
+        seed              = seed * 1103515245 + 12345;
+        vertexBuffer[v].y = (int)(seed >> 8) % 0x80000 - 0x40000;
+        seed              = seed * 1103515245 + 12345;
+        vertexBuffer[v].z = (int)(seed >> 8) % 0x80000 - 0x40000;
+    }
+    MatrixRotateXYZ(&matWorld, 0x23, 0x1C5, 0x91);
+    MatrixTranslateXYZ(&matView, -0x1234, 0x567, 0x89AB);
+    MatrixRotateX(&matTemp, 0x1E0);
+    MatrixMultiply(&matView, &matTemp);
+
+    double time[2] = { 0.0, 0.0 };
+    for (int k = 0; k < 2; ++k) {
+        Engine.useSIMD = k == 1;
+        memset(vertexBufferT, 0, VERTEXBUFFER_SIZE * sizeof(Vertex));
+        TransformVertexBuffer();
+        if (!k)
+            memcpy(scalar, vertexBufferT, VERTEXBUFFER_SIZE * sizeof(Vertex));
+
+        unsigned long long start = SDL_GetPerformanceCounter();
+        for (int p = 0; p < passCount; ++p) TransformVertexBuffer();
+        time[k] = (SDL_GetPerformanceCounter() - start) / freq / passCount;
+    }
+
+    int vertexMismatches = 0;
+    for (int v = 0; v < VERTEXBUFFER_SIZE; ++v) {
+        if (vertexBufferT[v].x != scalar[v].x || vertexBufferT[v].y != scalar[v].y || vertexBufferT[v].z != scalar[v].z)
+            vertexMismatches++;
+    }
+
+    // and the in place version scripts use, over an odd sized range
+    memcpy(vertexBufferT, vertexBuffer, VERTEXBUFFER_SIZE * sizeof(Vertex));
+    Engine.useSIMD = false;
+    TransformVertices(&matView, 3, VERTEXBUFFER_SIZE - 2);
+    memcpy(scalar, vertexBuffer, VERTEXBUFFER_SIZE * sizeof(Vertex));
+    memcpy(vertexBuffer, vertexBufferT, VERTEXBUFFER_SIZE * sizeof(Vertex));
+    Engine.useSIMD = true;
+    TransformVertices(&matView, 3, VERTEXBUFFER_SIZE - 2);
+    if (memcmp(scalar, vertexBuffer, VERTEXBUFFER_SIZE * sizeof(Vertex)))
+        vertexMismatches++;
+
+    PrintLog("Transform benchmark: %d vertices, scalar %.4fms, SIMD %.4fms (%.2fx), %d mismatched matrices, %d mismatched vertices",
+             VERTEXBUFFER_SIZE, time[0], time[1], time[1] > 0.0 ? time[0] / time[1] : 0.0, matrixMismatches, vertexMismatches);
+#if RETRO_USING_SSE2
+    PrintLog("Transform benchmark: %s", cpuHasSSE41 ? "vertices transformed with SSE4.1" : "no SSE4.1 on this CPU, vertices stay scalar");
+#endif
+
+    memcpy(vertexBuffer, saved, VERTEXBUFFER_SIZE * sizeof(Vertex));
+    memcpy(vertexBufferT, &saved[VERTEXBUFFER_SIZE], VERTEXBUFFER_SIZE * sizeof(Vertex));
+    matWorld       = savedWorld;
+    matView        = savedView;
+    vertexCount    = savedCount;
+    Engine.useSIMD = useSIMD;
+    delete[] saved;
+    delete[] scalar;
+}
+
+void BenchmarkProjectVertexBuffer()
+{
+    // a full vertex buffer with a spread of depths, some behind the camera and some far off screen
+    const int passCount     = 64;
+    Vertex *savedVertices   = new Vertex[VERTEXBUFFER_SIZE];
+    ProjectedVertex *scalar = new ProjectedVertex[VERTEXBUFFER_SIZE];
+    int savedCount          = vertexCount;
+    double freq             = (double)SDL_GetPerformanceFrequency() / 1000.0;
+    uint seed               = 0x7654321;
+
+    memcpy(savedVertices, vertexBufferT, VERTEXBUFFER_SIZE * sizeof(Vertex));
+    vertexCount = VERTEXBUFFER_SIZE;
+    for (int v = 0; v < VERTEXBUFFER_SIZE; ++v) {
+        seed               = seed * 1103515245 + 12345;
+        vertexBufferT[v].x = (int)(seed >> 8) % 0x40000 - 0x20000;
+        seed               = seed * 1103515245 + 12345;
+        vertexBufferT[v].y = (int)(seed >> 8) % 0x40000 - 0x20000;
+        seed               = seed * 1103515245 + 12345;
+        vertexBufferT[v].z = (int)(seed >> 8) % 0x20000 - 0x1000;
+    }
+
+    double time[2] = { 0.0, 0.0 };
+    for (int k = 0; k < 2; ++k) {
+        unsigned long long start = SDL_GetPerformanceCounter();
+        for (int p = 0; p < passCount; ++p) {
+            if (k)
+                ProjectVertices_SIMD(0, vertexCount);
+            else
+                ProjectVertices_Scalar(0, vertexCount);
+        }
+        time[k] = (SDL_GetPerformanceCounter() - start) / freq / passCount;
+        if (!k)
+            memcpy(scalar, vertexBufferP, VERTEXBUFFER_SIZE * sizeof(ProjectedVertex));
+    }
+
+    int mismatches = 0;
+    for (int v = 0; v < VERTEXBUFFER_SIZE; ++v) {
+        if (memcmp(&scalar[v], &vertexBufferP[v], sizeof(ProjectedVertex)))
+            mismatches++;
+    }
+    PrintLog("Projection benchmark: %d vertices, scalar %.4fms, SIMD %.4fms (%.2fx), %d mismatched vertices", VERTEXBUFFER_SIZE, time[0], time[1],
+             time[1] > 0.0 ? time[0] / time[1] : 0.0, mismatches);
+
+    memcpy(vertexBufferT, savedVertices, VERTEXBUFFER_SIZE * sizeof(Vertex));
+    vertexCount = savedCount;
+    delete[] savedVertices;
+    delete[] scalar;
+}
+
+// a face needs every vertex in front of the camera, and is skipped early if all of them are off the same edge of the screen
+static inline bool FaceIsVisible(Face *face)
+{
+    int codeA = vertexBufferP[face->a].outcode;
+    int codeB = vertexBufferP[face->b].outcode;
+    int codeC = vertexBufferP[face->c].outcode;
+    int codeD = vertexBufferP[face->d].outcode;
+    return !((codeA | codeB | codeC | codeD) & OUTCODE_NEAR) && !(codeA & codeB & codeC & codeD);
+}
+#endif
+
 void Draw3DScene(int spriteSheetID)
 {
+#if !RETRO_USE_ORIGINAL_CODE
+    ProjectVertexBuffer();
+#endif
+
     Vertex quad[4];
     for (int i = 0; i < faceCount; ++i) {
         Face *face = &faceBuffer[drawList3D[i].faceID];
@@ -341,6 +944,17 @@ void Draw3DScene(int spriteSheetID)
         switch (face->flag) {
             default: break;
             case FACE_FLAG_TEXTURED_3D:
+#if !RETRO_USE_ORIGINAL_CODE
+                if (FaceIsVisible(face)) {
+                    quad[0].x = vertexBufferP[face->a].x;
+                    quad[0].y = vertexBufferP[face->a].y;
+                    quad[1].x = vertexBufferP[face->b].x;
+                    quad[1].y = vertexBufferP[face->b].y;
+                    quad[2].x = vertexBufferP[face->c].x;
+                    quad[2].y = vertexBufferP[face->c].y;
+                    quad[3].x = vertexBufferP[face->d].x;
+                    quad[3].y = vertexBufferP[face->d].y;
+#else
                 if (vertexBufferT[face->a].z > 0 && vertexBufferT[face->b].z > 0 && vertexBufferT[face->c].z > 0 && vertexBufferT[face->d].z > 0) {
                     quad[0].x = SCREEN_CENTERX + projectionX * vertexBufferT[face->a].x / vertexBufferT[face->a].z;
                     quad[0].y = SCREEN_CENTERY - projectionY * vertexBufferT[face->a].y / vertexBufferT[face->a].z;
@@ -350,6 +964,7 @@ void Draw3DScene(int spriteSheetID)
                     quad[2].y = SCREEN_CENTERY - projectionY * vertexBufferT[face->c].y / vertexBufferT[face->c].z;
                     quad[3].x = SCREEN_CENTERX + projectionX * vertexBufferT[face->d].x / vertexBufferT[face->d].z;
                     quad[3].y = SCREEN_CENTERY - projectionY * vertexBufferT[face->d].y / vertexBufferT[face->d].z;
+#endif
                     quad[0].u = vertexBuffer[face->a].u;
                     quad[0].v = vertexBuffer[face->a].v;
                     quad[1].u = vertexBuffer[face->b].u;
@@ -384,6 +999,17 @@ void Draw3DScene(int spriteSheetID)
                 }
                 break;
             case FACE_FLAG_COLORED_3D:
+#if !RETRO_USE_ORIGINAL_CODE
+                if (FaceIsVisible(face)) {
+                    quad[0].x = vertexBufferP[face->a].x;
+                    quad[0].y = vertexBufferP[face->a].y;
+                    quad[1].x = vertexBufferP[face->b].x;
+                    quad[1].y = vertexBufferP[face->b].y;
+                    quad[2].x = vertexBufferP[face->c].x;
+                    quad[2].y = vertexBufferP[face->c].y;
+                    quad[3].x = vertexBufferP[face->d].x;
+                    quad[3].y = vertexBufferP[face->d].y;
+#else
                 if (vertexBufferT[face->a].z > 0 && vertexBufferT[face->b].z > 0 && vertexBufferT[face->c].z > 0 && vertexBufferT[face->d].z > 0) {
                     quad[0].x = SCREEN_CENTERX + projectionX * vertexBufferT[face->a].x / vertexBufferT[face->a].z;
                     quad[0].y = SCREEN_CENTERY - projectionY * vertexBufferT[face->a].y / vertexBufferT[face->a].z;
@@ -393,6 +1019,7 @@ void Draw3DScene(int spriteSheetID)
                     quad[2].y = SCREEN_CENTERY - projectionY * vertexBufferT[face->c].y / vertexBufferT[face->c].z;
                     quad[3].x = SCREEN_CENTERX + projectionX * vertexBufferT[face->d].x / vertexBufferT[face->d].z;
                     quad[3].y = SCREEN_CENTERY - projectionY * vertexBufferT[face->d].y / vertexBufferT[face->d].z;
+#endif
                     DrawFace(quad, face->color);
                 }
                 break;
@@ -411,6 +1038,17 @@ void Draw3DScene(int spriteSheetID)
                 }
                 break;
             case FACE_FLAG_FADED:
+#if !RETRO_USE_ORIGINAL_CODE
+                if (FaceIsVisible(face)) {
+                    quad[0].x = vertexBufferP[face->a].x;
+                    quad[0].y = vertexBufferP[face->a].y;
+                    quad[1].x = vertexBufferP[face->b].x;
+                    quad[1].y = vertexBufferP[face->b].y;
+                    quad[2].x = vertexBufferP[face->c].x;
+                    quad[2].y = vertexBufferP[face->c].y;
+                    quad[3].x = vertexBufferP[face->d].x;
+                    quad[3].y = vertexBufferP[face->d].y;
+#else
                 if (vertexBufferT[face->a].z > 0 && vertexBufferT[face->b].z > 0 && vertexBufferT[face->c].z > 0 && vertexBufferT[face->d].z > 0) {
                     quad[0].x = SCREEN_CENTERX + projectionX * vertexBufferT[face->a].x / vertexBufferT[face->a].z;
                     quad[0].y = SCREEN_CENTERY - projectionY * vertexBufferT[face->a].y / vertexBufferT[face->a].z;
@@ -420,6 +1058,7 @@ void Draw3DScene(int spriteSheetID)
                     quad[2].y = SCREEN_CENTERY - projectionY * vertexBufferT[face->c].y / vertexBufferT[face->c].z;
                     quad[3].x = SCREEN_CENTERX + projectionX * vertexBufferT[face->d].x / vertexBufferT[face->d].z;
                     quad[3].y = SCREEN_CENTERY - projectionY * vertexBufferT[face->d].y / vertexBufferT[face->d].z;
+#endif
 
                     int fogStr = 0;
                     if ((drawList3D[i].depth - 0x8000) >> 8 >= 0)
@@ -485,8 +1124,13 @@ void Draw3DScene(int spriteSheetID)
                 break;
             case FACE_FLAG_3DSPRITE:
                 if (vertexBufferT[face->a].z > 0) {
+#if !RETRO_USE_ORIGINAL_CODE
+                    int xpos = vertexBufferP[face->a].x;
+                    int ypos = vertexBufferP[face->a].y;
+#else
                     int xpos = SCREEN_CENTERX + projectionX * vertexBufferT[face->a].x / vertexBufferT[face->a].z;
                     int ypos = SCREEN_CENTERY - projectionY * vertexBufferT[face->a].y / vertexBufferT[face->a].z;
+#endif
 
                     ObjectScript *scriptInfo = &objectScriptList[vertexBuffer[face->a].u];
                     SpriteFrame *frame       = &scriptFrames[scriptInfo->frameListOffset + vertexBuffer[face->b].u];
@@ -47,6 +47,23 @@ struct DrawListEntry3D {
     int depth;
 };
 
+#if !RETRO_USE_ORIGINAL_CODE
+// off-screen flags for projected vertices, the screen edges match the checks DrawFace & co make before drawing
+enum VertexOutcodes {
+    OUTCODE_NEAR   = 1 << 0,
+    OUTCODE_LEFT   = 1 << 1,
+    OUTCODE_RIGHT  = 1 << 2,
+    OUTCODE_TOP    = 1 << 3,
+    OUTCODE_BOTTOM = 1 << 4,
+};
+
+struct ProjectedVertex {
+    int x;
+    int y;
+    int outcode;
+};
+#endif
+
 extern int vertexCount;
 extern int faceCount;
 
@@ -60,6 +77,9 @@ extern Vertex vertexBuffer[VERTEXBUFFER_SIZE];
 extern Vertex vertexBufferT[VERTEXBUFFER_SIZE];
 
 extern DrawListEntry3D drawList3D[FACEBUFFER_SIZE];
+#if !RETRO_USE_ORIGINAL_CODE
+extern ProjectedVertex vertexBufferP[VERTEXBUFFER_SIZE];
+#endif
 
 extern int projectionX;
 extern int projectionY;
@@ -87,6 +107,12 @@ void MatrixInverse(Matrix *matrix);
 void TransformVertexBuffer();
 void TransformVertices(Matrix *matrix, int startIndex, int endIndex);
 void Sort3DDrawList();
+#if !RETRO_USE_ORIGINAL_CODE
+void ProjectVertexBuffer();
+void BenchmarkSort3DDrawList();
+void BenchmarkTransformVertexBuffer();
+void BenchmarkProjectVertexBuffer();
+#endif
 void Draw3DScene(int spriteSheetID);
 
 void ProcessScanEdge(Vertex *vertA, Vertex *vertB);
@@ -185,7 +185,8 @@ byte TraceGifPrefix(uint *prefix, int code, int clearCode)
 
     return code;
 }
-void ReadGifPictureData(int width, int height, bool interlaced, byte *gfxData, int offset)
+// the original decoder, every byte goes through FileRead & every code walks its prefix chain
+static void ReadGifPictureLines(int width, int height, bool interlaced, byte *gfxData, int offset)
 {
     int initialRow[] = { 0, 4, 2, 1 };
     int rowInc[]     = { 8, 8, 4, 2 };
@@ -200,12 +201,555 @@ void ReadGifPictureData(int width, int height, bool interlaced, byte *gfxData, i
     }
 }
 
+#if !RETRO_USE_ORIGINAL_CODE
+// where a dictionary string was first written out, every code's string is already in the output by the time it's used
+struct GifString {
+    int start;
+    int length;
+};
+
+int gifDecodeCount                 = 0;
+int gifFallbackCount               = 0;
+int gifMismatchCount               = 0;
+unsigned long long gifDecodeTime   = 0;
+unsigned long long gifOriginalTime = 0;
+
+// the output keeps enough slack past the end for any string, so runs are copied 8 bytes at a time
+// dst can be less than 8 bytes past src, so each chunk's loaded whole before it's stored (memcpy can't overlap)
+// a string's source always ends at or before dst, so only the slack bytes past its length can pick up what's been stored
+static inline void CopyGifString(byte *dst, const byte *src, int length)
+{
+    do {
+        unsigned long long chunk;
+        memcpy(&chunk, src, sizeof(chunk));
+        memcpy(dst, &chunk, sizeof(chunk));
+        dst += 8;
+        src += 8;
+        length -= 8;
+    } while (length > 0);
+}
+
+// decodes a whole LZW stream that's already been pulled out of its sub-blocks, keeping the original decoder's code width & table rules
+// anything it'd have handled differently (running out of data, an early end code, a full table with no clear) is left to it instead
+static bool DecodeGifData(const byte *data, int dataSize, int depth, byte *pixels, int pixelCount)
+{
+    if (depth < 1 || depth > 8)
+        return false;
+
+    GifString strings[LZ_MAX_CODE + 1];
+    int clearCode      = 1 << depth;
+    int eofCode        = clearCode + 1;
+    int runningCode    = eofCode + 1;
+    int runningBits    = depth + 1;
+    int maxCodePlusOne = 1 << runningBits;
+    int prevCode       = NO_SUCH_CODE;
+    int prevStart      = 0;
+    int prevLength     = 0;
+    long long bitPos   = 0;
+    long long bitCount = (long long)dataSize * 8;
+
+    int pos = 0;
+    while (pos < pixelCount) {
+        if (bitPos + runningBits > bitCount)
+            return false;
+
+        uint bits;
+        memcpy(&bits, &data[bitPos >> 3], sizeof(bits));
+        int code = (bits >> (bitPos & 7)) & codeMasks[runningBits];
+        bitPos += runningBits;
+        if (++runningCode > maxCodePlusOne && runningBits < LZ_BITS) {
+            maxCodePlusOne <<= 1;
+            runningBits++;
+        }
+
+        if (code == clearCode) {
+            runningCode    = eofCode + 1;
+            runningBits    = depth + 1;
+            maxCodePlusOne = 1 << runningBits;
+            prevCode       = NO_SUCH_CODE;
+            continue;
+        }
+
+        int length = 0;
+        if (code < clearCode) {
+            pixels[pos] = code;
+            length      = 1;
+        }
+        else if (code > eofCode && code < runningCode - 2) {
+            length = strings[code].length;
+            CopyGifString(&pixels[pos], &pixels[strings[code].start], length);
+        }
+        else if (code == runningCode - 2 && prevCode != NO_SUCH_CODE) {
+            // the code being defined right now, the previous string followed by its own first pixel
+            length = prevLength + 1;
+            CopyGifString(&pixels[pos], &pixels[prevStart], prevLength);
+            pixels[pos + prevLength] = pixels[prevStart];
+        }
+        else {
+            return false;
+        }
+
+        if (prevCode != NO_SUCH_CODE) {
+            if (runningCode > FIRST_CODE)
+                return false;
+            strings[runningCode - 2].start  = prevStart;
+            strings[runningCode - 2].length = prevLength + 1;
+        }
+        prevCode   = code;
+        prevStart  = pos;
+        prevLength = length;
+        pos += length;
+    }
+    return true;
+}
+
+// reads the rest of the image's sub-blocks in one go & decodes them from memory
+static bool ReadGifPictureBulk(int width, int height, bool interlaced, byte *gfxData, int offset)
+{
+    int pixelCount = width * height;
+    if (pixelCount <= 0)
+        return false;
+
+    // every code is at most 12 bits & at least a pixel, so this covers any sane stream without reading far past it (videos keep going)
+    int dataSize  = (Engine.usingDataFile ? vFileSize : fileSize) - (int)GetFilePosition();
+    int dataBound = 0x400 + (pixelCount > 0x10000000 ? 0x20000000 : pixelCount * 2);
+    if (dataSize > dataBound)
+        dataSize = dataBound;
+    if (dataSize < 2)
+        return false;
+
+    byte *data = new byte[dataSize + sizeof(uint)];
+    FileRead(data, dataSize);
+
+    // strip the sub-block sizes, the data only ever moves down
+    int depth    = data[0];
+    int blockPos = 1;
+    int size     = 0;
+    while (blockPos < dataSize) {
+        int blockSize = data[blockPos++];
+        if (!blockSize)
+            break;
+        if (blockSize > dataSize - blockPos)
+            blockSize = dataSize - blockPos;
+        memmove(&data[size], &data[blockPos], blockSize);
+        size += blockSize;
+        blockPos += blockSize;
+    }
+    memset(&data[size], 0, sizeof(uint));
+
+    byte *pixels = new byte[pixelCount + LZ_MAX_CODE + 0x10];
+    bool decoded = DecodeGifData(data, size, depth, pixels, pixelCount);
+    if (decoded) {
+        if (interlaced) {
+            int initialRow[] = { 0, 4, 2, 1 };
+            int rowInc[]     = { 8, 8, 4, 2 };
+            byte *row        = pixels;
+            for (int p = 0; p < 4; ++p) {
+                for (int y = initialRow[p]; y < height; y += rowInc[p], row += width) {
+                    memcpy(&gfxData[y * width + offset], row, width);
+                }
+            }
+        }
+        else {
+            memcpy(&gfxData[offset], pixels, pixelCount);
+        }
+    }
+
+    delete[] pixels;
+    delete[] data;
+    return decoded;
+}
+
+void ReportGifDecoding()
+{
+    if (!gifDecodeCount)
+        return;
+
+    double freq = (double)SDL_GetPerformanceFrequency() / 1000.0;
+    PrintLog("GIF decoding: %d images in %.3fms, %d left to the original decoder", gifDecodeCount, gifDecodeTime / freq, gifFallbackCount);
+    if (gifOriginalTime) {
+        PrintLog("GIF decoding: the original decoder took %.3fms (%.2fx), %d mismatched images", gifOriginalTime / freq,
+                 gifDecodeTime ? (double)gifOriginalTime / gifDecodeTime : 0.0, gifMismatchCount);
+    }
+
+    gifDecodeCount   = 0;
+    gifFallbackCount = 0;
+    gifMismatchCount = 0;
+    gifDecodeTime    = 0;
+    gifOriginalTime  = 0;
+}
+#endif
+
+void ReadGifPictureData(int width, int height, bool interlaced, byte *gfxData, int offset)
+{
+#if RETRO_USE_ORIGINAL_CODE
+    ReadGifPictureLines(width, height, interlaced, gfxData, offset);
+#else
+    int filePos              = (int)GetFilePosition();
+    unsigned long long start = SDL_GetPerformanceCounter();
+    bool decoded             = ReadGifPictureBulk(width, height, interlaced, gfxData, offset);
+    if (!decoded) {
+        SetFilePosition(filePos);
+        ReadGifPictureLines(width, height, interlaced, gfxData, offset);
+        ++gifFallbackCount;
+    }
+    gifDecodeTime += SDL_GetPerformanceCounter() - start;
+    ++gifDecodeCount;
+
+    if (decoded && Engine.runBenchmarks) {
+        // decode it again the original way to check & time against
+        byte *pixels = new byte[width * height];
+        SetFilePosition(filePos);
+        start = SDL_GetPerformanceCounter();
+        ReadGifPictureLines(width, height, interlaced, pixels, 0);
+        gifOriginalTime += SDL_GetPerformanceCounter() - start;
+        if (memcmp(pixels, &gfxData[offset], width * height)) {
+            PrintLog("GIF decoding: '%s' decoded differently to the original decoder", fileName);
+            ++gifMismatchCount;
+        }
+        delete[] pixels;
+    }
+#endif
+}
+
+#if !RETRO_USE_ORIGINAL_CODE
+#define SHEETCACHE_COUNT (SURFACE_COUNT)
+
+// a decoded copy of a sheet from an earlier stage
+struct SheetCacheEntry {
+    char fileName[0x80];
+    uint fileHash;
+    int width;
+    int height;
+    int depth;
+    byte *pixels;
+    uint lastUsed;
+};
+
+SheetCacheEntry sheetCache[SHEETCACHE_COUNT];
+int sheetCacheSize   = 0;
+uint sheetCacheClock = 0;
+
+int sheetCacheHits        = 0;
+int sheetCacheMisses      = 0;
+long long sheetCacheSaved = 0;
+
+static SheetCacheEntry *FindCachedSheet(const char *fileName)
+{
+    for (int i = 0; i < SHEETCACHE_COUNT; ++i) {
+        if (sheetCache[i].pixels && StrComp(sheetCache[i].fileName, fileName))
+            return &sheetCache[i];
+    }
+    return NULL;
+}
+
+static void EvictCachedSheet(SheetCacheEntry *entry)
+{
+    sheetCacheSize -= entry->width * entry->height;
+    delete[] entry->pixels;
+    MEM_ZEROP(entry);
+}
+
+// copies the sheet into the cache, dropping the least recently used sheets until it fits the budget
+static void CacheSheet(int sheetID)
+{
+    GFXSurface *surface = &gfxSurface[sheetID];
+    int size            = surface->width * surface->height;
+    if (!surface->fileHash || size <= 0 || size > Engine.sheetCacheSize * 1024)
+        return;
+
+    SheetCacheEntry *entry = FindCachedSheet(surface->fileName);
+    if (entry && entry->fileHash == surface->fileHash && entry->width == surface->width && entry->height == surface->height) {
+        entry->lastUsed = ++sheetCacheClock;
+        return;
+    }
+    if (entry)
+        EvictCachedSheet(entry);
+
+    for (;;) {
+        entry                   = NULL;
+        SheetCacheEntry *oldest = NULL;
+        for (int i = 0; i < SHEETCACHE_COUNT; ++i) {
+            if (!sheetCache[i].pixels)
+                entry = &sheetCache[i];
+            else if (!oldest || sheetCache[i].lastUsed < oldest->lastUsed)
+                oldest = &sheetCache[i];
+        }
+
+        if (entry && sheetCacheSize + size <= Engine.sheetCacheSize * 1024)
+            break;
+        EvictCachedSheet(oldest);
+    }
+
+    StrCopy(entry->fileName, surface->fileName);
+    entry->fileHash = surface->fileHash;
+    entry->width    = surface->width;
+    entry->height   = surface->height;
+    entry->depth    = surface->depth;
+    entry->pixels   = new byte[size];
+    entry->lastUsed = ++sheetCacheClock;
+    memcpy(entry->pixels, &graphicData[surface->dataPosition], size);
+    sheetCacheSize += size;
+}
+
+// fills the sheet from the cache if it holds the same file, otherwise notes the file's stamp for when the sheet gets demoted
+// the stamp's taken without reading the file, so a miss only reads it the once, to decode it
+static bool LoadCachedSheet(const char *filePath, int sheetID)
+{
+    GFXSurface *surface = &gfxSurface[sheetID];
+    surface->fileHash   = 0;
+    if (Engine.sheetCacheSize <= 0)
+        return false;
+
+    uint hash              = GetFileStamp(filePath);
+    SheetCacheEntry *entry = FindCachedSheet(filePath);
+    if (entry && entry->fileHash != hash) {
+        EvictCachedSheet(entry);
+        entry = NULL;
+    }
+
+    surface->fileHash = hash;
+    if (!entry) {
+        ++sheetCacheMisses;
+        return false;
+    }
+
+    StrCopy(surface->fileName, filePath);
+    surface->width  = entry->width;
+    surface->height = entry->height;
+    surface->depth  = entry->depth;
+#if RETRO_SOFTWARE_RENDER
+    surface->widthShift = 0;
+    int w               = surface->width;
+    while (w > 1) {
+        w >>= 1;
+        ++surface->widthShift;
+    }
+#endif
+    if (!AllocateSurfaceData(sheetID)) {
+        StrCopy(surface->fileName, "");
+        return false;
+    }
+    memcpy(&graphicData[surface->dataPosition], entry->pixels, entry->width * entry->height);
+    BuildSurfaceSpans(sheetID);
+
+    entry->lastUsed = ++sheetCacheClock;
+    ++sheetCacheHits;
+    sheetCacheSaved += entry->width * entry->height;
+    return true;
+}
+
+// a decoded sheet saved to the Baked folder, the pixels follow the header exactly as they sit in graphicData
+struct BakedSheetHeader {
+    byte signature[4];
+    uint sourceHash;
+    ushort width;
+    ushort height;
+    byte depth;
+    byte padding[3];
+};
+
+byte bakedSheetSignature[4] = { 'R', 'S', 'B', '2' };
+
+int bakedSheetLoads        = 0;
+int bakedSheetWrites       = 0;
+long long bakedSheetLoaded = 0;
+bool bakedFolderMissing    = false;
+
+// "Data/Sprites/Global/Items.gif" is kept as "Baked/Data.Sprites.Global.Items.gif.bin", so only the one folder's needed
+static void GetBakedSheetPath(char *dest, const char *filePath)
+{
+    sprintf(dest, BASE_PATH "Baked/%s.bin", filePath);
+    for (char *c = dest + StrLength(BASE_PATH "Baked/"); *c; ++c) {
+        if (*c == '/' || *c == '\\')
+            *c = '.';
+    }
+}
+
+// the sheet cache might've stamped the file already
+static uint GetSheetHash(const char *filePath, int sheetID)
+{
+    if (!gfxSurface[sheetID].fileHash)
+        gfxSurface[sheetID].fileHash = GetFileStamp(filePath);
+    return gfxSurface[sheetID].fileHash;
+}
+
+// reads the sheet straight into graphicData if it was baked from the same file, the source is only stamped, never read
+// only looked for with BakeSheets on, so default builds don't pay for a failed open & a stamp on every load
+static bool LoadBakedSheet(const char *filePath, int sheetID)
+{
+    if (!Engine.bakeSheets || bakedFolderMissing)
+        return false;
+
+    char bakedPath[0x100];
+    GetBakedSheetPath(bakedPath, filePath);
+    FileIO *file = fOpen(bakedPath, "rb");
+    if (!file)
+        return false;
+
+    BakedSheetHeader header;
+    bool loaded = false;
+    if (fRead(&header, 1, sizeof(header), file) == sizeof(header) && !memcmp(header.signature, bakedSheetSignature, sizeof(bakedSheetSignature))
+        && header.sourceHash == GetSheetHash(filePath, sheetID)) {
+        GFXSurface *surface = &gfxSurface[sheetID];
+        StrCopy(surface->fileName, filePath);
+        surface->width  = header.width;
+        surface->height = header.height;
+        surface->depth  = header.depth;
+#if RETRO_SOFTWARE_RENDER
+        surface->widthShift = 0;
+        int w               = surface->width;
+        while (w > 1) {
+            w >>= 1;
+            ++surface->widthShift;
+        }
+#endif
+        int size = surface->width * surface->height;
+        if (!AllocateSurfaceData(sheetID)) {
+            StrCopy(surface->fileName, "");
+        }
+        else if ((int)fRead(&graphicData[surface->dataPosition], 1, size, file) != size) {
+            RemoveGraphicsFile("", sheetID);
+        }
+        else {
+            BuildSurfaceSpans(sheetID);
+            ++bakedSheetLoads;
+            bakedSheetLoaded += size;
+            loaded = true;
+        }
+    }
+    fClose(file);
+    return loaded;
+}
+
+// saves a freshly decoded sheet so the next load can skip decoding it
+static void BakeSheet(const char *filePath, int sheetID)
+{
+    GFXSurface *surface = &gfxSurface[sheetID];
+    int size            = surface->width * surface->height;
+    if (!Engine.bakeSheets || bakedFolderMissing || !StrComp(surface->fileName, filePath) || size <= 0 || surface->width > 0xFFFF
+        || surface->height > 0xFFFF)
+        return;
+
+    BakedSheetHeader header;
+    MEM_ZERO(header);
+    memcpy(header.signature, bakedSheetSignature, sizeof(bakedSheetSignature));
+    header.sourceHash = GetSheetHash(filePath, sheetID);
+    header.width      = surface->width;
+    header.height     = surface->height;
+    header.depth      = surface->depth;
+    if (!header.sourceHash)
+        return;
+
+    char bakedPath[0x100];
+    GetBakedSheetPath(bakedPath, filePath);
+    FileIO *file = fOpen(bakedPath, "wb");
+    if (!file) {
+        PrintLog("Baked sheets: couldn't write %s, sheets won't be baked until the Baked folder's made", bakedPath);
+        bakedFolderMissing = true;
+        return;
+    }
+    fWrite(&header, 1, sizeof(header), file);
+    fWrite(&graphicData[surface->dataPosition], 1, size, file);
+    fClose(file);
+    ++bakedSheetWrites;
+}
+
+// stage teardown, the sheet is removed but a decoded copy is kept for the next stage
+void DemoteGraphicsFile(int sheetID)
+{
+    if (StrLength(gfxSurface[sheetID].fileName) > 0)
+        CacheSheet(sheetID);
+    RemoveGraphicsFile("", sheetID);
+}
+
+void ReportSheetCache()
+{
+    if (sheetCacheHits + sheetCacheMisses > 0) {
+        PrintLog("Sheet cache: %d hits, %d misses, %lld KB of decoding skipped, %d KB cached", sheetCacheHits, sheetCacheMisses,
+                 sheetCacheSaved / 1024, sheetCacheSize / 1024);
+    }
+    if (bakedSheetLoads + bakedSheetWrites > 0)
+        PrintLog("Baked sheets: %d loaded (%lld KB), %d baked", bakedSheetLoads, bakedSheetLoaded / 1024, bakedSheetWrites);
+    sheetCacheHits   = 0;
+    sheetCacheMisses = 0;
+    sheetCacheSaved  = 0;
+    bakedSheetLoads  = 0;
+    bakedSheetWrites = 0;
+    bakedSheetLoaded = 0;
+}
+
+void ReleaseSheetCache()
+{
+    for (int i = 0; i < SHEETCACHE_COUNT; ++i) {
+        if (sheetCache[i].pixels)
+            EvictCachedSheet(&sheetCache[i]);
+    }
+}
+#endif
+
+#if !RETRO_USE_ORIGINAL_CODE
+#define SURFACEINDEX_SIZE (0x200)
+
+// open addressed, from a sheet path's StrHash to the gfxSurface slot it was loaded into (+1, 0 being empty)
+// entries aren't removed with their sheet, they're overwritten once the slot's been freed or given a sheet with another hash
+uint surfaceIndexHash[SURFACEINDEX_SIZE];
+short surfaceIndexSlot[SURFACEINDEX_SIZE];
+uint surfaceHashes[SURFACE_COUNT];
+
+// a sheet can be loaded twice if it's added again while there's a free slot before it, the lowest copy's what the original search found
+static int FindSurfaceIndex(const char *filePath, uint hash)
+{
+    int found = -1;
+    for (int i = 0; i < SURFACEINDEX_SIZE; ++i) {
+        int entry = (hash + i) & (SURFACEINDEX_SIZE - 1);
+        if (!surfaceIndexSlot[entry])
+            break;
+        int sheetID = surfaceIndexSlot[entry] - 1;
+        if (surfaceIndexHash[entry] == hash && (found < 0 || sheetID < found) && StrComp(gfxSurface[sheetID].fileName, filePath))
+            found = sheetID;
+    }
+    return found;
+}
+
+static void AddSurfaceIndex(uint hash, int sheetID)
+{
+    surfaceHashes[sheetID] = hash;
+    for (int i = 0; i < SURFACEINDEX_SIZE; ++i) {
+        int entry = (hash + i) & (SURFACEINDEX_SIZE - 1);
+        int slot  = surfaceIndexSlot[entry] - 1;
+        if (slot < 0 || slot == sheetID || !gfxSurface[slot].fileName[0] || surfaceHashes[slot] != surfaceIndexHash[entry]) {
+            surfaceIndexHash[entry] = hash;
+            surfaceIndexSlot[entry] = sheetID + 1;
+            return;
+        }
+    }
+}
+#endif
+
 int AddGraphicsFile(const char *filePath)
 {
     char sheetPath[0x100];
 
     StrCopy(sheetPath, "Data/Sprites/");
     StrAdd(sheetPath, filePath);
+#if !RETRO_USE_ORIGINAL_CODE
+    // the original search stopped at the first free slot, so a sheet past it doesn't count & a new one's loaded there
+    while (firstFreeSurface < SURFACE_COUNT && gfxSurface[firstFreeSurface].fileName[0]) ++firstFreeSurface;
+
+    uint hash   = StrHash(sheetPath);
+    int sheetID = FindSurfaceIndex(sheetPath, hash);
+    if (sheetID >= 0 && sheetID < firstFreeSurface)
+        return sheetID;
+    if (firstFreeSurface == SURFACE_COUNT) // Max Sheet cnt
+        return 0;
+    sheetID = firstFreeSurface;
+
+    if (LoadCachedSheet(sheetPath, sheetID) || LoadBakedSheet(sheetPath, sheetID)) {
+        AddSurfaceIndex(hash, sheetID);
+        return sheetID;
+    }
+#else
     int sheetID = 0;
     while (StrLength(gfxSurface[sheetID].fileName) > 0) {
         if (StrComp(gfxSurface[sheetID].fileName, sheetPath))
@@ -213,12 +757,18 @@ int AddGraphicsFile(const char *filePath)
         if (++sheetID == SURFACE_COUNT) // Max Sheet cnt
             return 0;
     }
+#endif
     byte fileExtension = (byte)sheetPath[(StrLength(sheetPath) - 1) & 0xFF];
     switch (fileExtension) {
         case 'f': LoadGIFFile(sheetPath, sheetID); break;
         case 'p': LoadBMPFile(sheetPath, sheetID); break;
         case 'r': LoadPVRFile(sheetPath, sheetID); break;
     }
+#if !RETRO_USE_ORIGINAL_CODE
+    BakeSheet(sheetPath, sheetID);
+    if (StrLength(gfxSurface[sheetID].fileName) > 0)
+        AddSurfaceIndex(hash, sheetID);
+#endif
 
     return sheetID;
 }
@@ -232,7 +782,13 @@ void RemoveGraphicsFile(const char *filePath, int sheetID)
     }
 
     if (sheetID >= 0 && StrLength(gfxSurface[sheetID].fileName)) {
+#if !RETRO_USE_ORIGINAL_CODE
+        ReleaseSurfaceSpans(sheetID);
+        if (sheetID < firstFreeSurface)
+            firstFreeSurface = sheetID;
+#endif
         StrCopy(gfxSurface[sheetID].fileName, "");
+#if RETRO_USE_ORIGINAL_CODE
         int dataPosStart = gfxSurface[sheetID].dataPosition;
         int dataPosEnd   = gfxSurface[sheetID].dataPosition + gfxSurface[sheetID].height * gfxSurface[sheetID].width;
         for (int i = GFXDATA_SIZE - dataPosEnd; i > 0; --i) graphicData[dataPosStart++] = graphicData[dataPosEnd++];
@@ -241,8 +797,95 @@ void RemoveGraphicsFile(const char *filePath, int sheetID)
             if (gfxSurface[i].dataPosition > gfxSurface[sheetID].dataPosition)
                 gfxSurface[i].dataPosition -= gfxSurface[sheetID].height * gfxSurface[sheetID].width;
         }
+#else
+        // nothing gets moved, the sheet's block is left as a gap for the next sheet that fits in it
+        gfxDataPosition = 0;
+        for (int i = 0; i < SURFACE_COUNT; ++i) {
+            int dataPosEnd = gfxSurface[i].dataPosition + gfxSurface[i].height * gfxSurface[i].width;
+            if (StrLength(gfxSurface[i].fileName) > 0 && dataPosEnd > gfxDataPosition)
+                gfxDataPosition = dataPosEnd;
+        }
+#endif
+    }
+}
+
+#if !RETRO_USE_ORIGINAL_CODE
+// fills blocks with the IDs of every loaded sheet besides skipID, in the order their data is laid out
+static int GetSurfaceBlocks(int *blocks, int skipID)
+{
+    int count = 0;
+    for (int i = 0; i < SURFACE_COUNT; ++i) {
+        if (i == skipID || !StrLength(gfxSurface[i].fileName) || gfxSurface[i].width * gfxSurface[i].height <= 0)
+            continue;
+
+        int b = count++;
+        for (; b > 0 && gfxSurface[blocks[b - 1]].dataPosition > gfxSurface[i].dataPosition; --b) blocks[b] = blocks[b - 1];
+        blocks[b] = i;
+    }
+    return count;
+}
+
+// slides every sheet besides skipID down over the gaps between them, only the live data is moved
+static void PackSurfaceData(int skipID)
+{
+    int blocks[SURFACE_COUNT];
+    int count     = GetSurfaceBlocks(blocks, skipID);
+    int position  = 0;
+    int movedSize = 0;
+    for (int b = 0; b < count; ++b) {
+        GFXSurface *surface = &gfxSurface[blocks[b]];
+        int size            = surface->width * surface->height;
+        if (surface->dataPosition != position) {
+            memmove(&graphicData[position], &graphicData[surface->dataPosition], size);
+            surface->dataPosition = position;
+            movedSize += size;
+        }
+        position += size;
+    }
+    gfxDataPosition = position;
+
+    if (movedSize)
+        PrintLog("Gfx data: defragmented %d sheets, moved %d KB", count, movedSize / 1024);
+}
+
+void DefragmentGraphicData() { PackSurfaceData(-1); }
+
+// places the sheet's pixels in the first gap left by a removed sheet that fits them, or on the end if none do
+bool AllocateSurfaceData(int sheetID)
+{
+    GFXSurface *surface = &gfxSurface[sheetID];
+    int size            = surface->width * surface->height;
+
+    int blocks[SURFACE_COUNT];
+    int count    = GetSurfaceBlocks(blocks, sheetID);
+    int position = 0;
+    for (int b = 0; b < count; ++b) {
+        GFXSurface *block = &gfxSurface[blocks[b]];
+        if (block->dataPosition - position >= size)
+            break;
+        if (block->dataPosition + block->width * block->height > position)
+            position = block->dataPosition + block->width * block->height;
+    }
+
+    if (size < 0 || !ReserveGraphicData(position + size)) {
+        // none of the gaps fit on their own, but all of them together might
+        PackSurfaceData(sheetID);
+        position = gfxDataPosition;
+        if (size < 0 || !ReserveGraphicData(position + size)) {
+            // leave it as an empty sheet rather than one pointing at someone else's pixels
+            surface->width        = 0;
+            surface->height       = 0;
+            surface->dataPosition = 0;
+            return false;
+        }
     }
+
+    surface->dataPosition = position;
+    if (position + size > gfxDataPosition)
+        gfxDataPosition = position + size;
+    return true;
 }
+#endif
 
 int LoadBMPFile(const char *filePath, byte sheetID)
 {
@@ -273,7 +916,15 @@ int LoadBMPFile(const char *filePath, byte sheetID)
         surface->height |= fileBuffer << 24;
 
         SetFilePosition(info.vfileSize - surface->height * surface->width);
+#if RETRO_USE_ORIGINAL_CODE
         surface->dataPosition = gfxDataPosition;
+#else
+        if (!AllocateSurfaceData(sheetID)) {
+            PrintLog("WARNING: Exceeded max gfx size!");
+            CloseFile();
+            return true;
+        }
+#endif
         byte *gfxData         = &graphicData[surface->dataPosition + surface->width * (surface->height - 1)];
         for (int y = 0; y < surface->height; ++y) {
             for (int x = 0; x < surface->width; ++x) {
@@ -282,7 +933,9 @@ int LoadBMPFile(const char *filePath, byte sheetID)
             }
             gfxData -= 2 * surface->width;
         }
+#if RETRO_USE_ORIGINAL_CODE
         gfxDataPosition += surface->height * surface->width;
+#endif
 
 #if RETRO_SOFTWARE_RENDER
         surface->widthShift = 0;
@@ -293,10 +946,14 @@ int LoadBMPFile(const char *filePath, byte sheetID)
         }
 #endif
 
+#if RETRO_USE_ORIGINAL_CODE
         if (gfxDataPosition >= GFXDATA_SIZE) {
             gfxDataPosition = 0;
             PrintLog("WARNING: Exceeded max gfx size!");
         }
+#else
+        BuildSurfaceSpans(sheetID);
+#endif
 
         CloseFile();
         return true;
@@ -356,7 +1013,9 @@ int LoadGIFFile(const char *filePath, byte sheetID)
             } while (c != 0x100);
         }
 
+#if RETRO_USE_ORIGINAL_CODE
         surface->dataPosition = gfxDataPosition;
+#endif
 
 #if RETRO_SOFTWARE_RENDER
         surface->widthShift = 0;
@@ -367,12 +1026,21 @@ int LoadGIFFile(const char *filePath, byte sheetID)
         }
 #endif
 
+#if RETRO_USE_ORIGINAL_CODE
         gfxDataPosition += surface->width * surface->height;
         if (gfxDataPosition < GFXDATA_SIZE) {
+#else
+        if (AllocateSurfaceData(sheetID)) {
+#endif
             ReadGifPictureData(surface->width, surface->height, interlaced, graphicData, surface->dataPosition);
+#if !RETRO_USE_ORIGINAL_CODE
+            BuildSurfaceSpans(sheetID);
+#endif
         }
         else {
+#if RETRO_USE_ORIGINAL_CODE
             gfxDataPosition = 0;
+#endif
             PrintLog("WARNING: Exceeded max gfx size!");
         }
 
@@ -403,6 +1071,7 @@ int LoadPVRFile(const char *filePath, byte sheetID)
 
         surface->width        = width;
         surface->height       = height;
+#if RETRO_USE_ORIGINAL_CODE
         surface->dataPosition = gfxDataPosition;
         gfxDataPosition += surface->width * surface->height;
 
@@ -410,6 +1079,10 @@ int LoadPVRFile(const char *filePath, byte sheetID)
             gfxDataPosition = 0;
             PrintLog("WARNING: Exceeded max gfx size!");
         }
+#else
+        if (!AllocateSurfaceData(sheetID))
+            PrintLog("WARNING: Exceeded max gfx size!");
+#endif
 
 #if RETRO_SOFTWARE_RENDER
         surface->widthShift = 0;
@@ -437,3 +1110,144 @@ int LoadPVRFile(const char *filePath, byte sheetID)
     }
     return false;
 }
+
+#if !RETRO_USE_ORIGINAL_CODE
+#define BENCHMARK_STAGE_SHEETS (48)
+
+// how sheets used to be removed, everything after the sheet was moved down over it
+static void ShiftOutSurface(int sheetID, long long *movedSize, long long *originalSize)
+{
+    GFXSurface *surface = &gfxSurface[sheetID];
+    int size            = surface->width * surface->height;
+    int dataPosEnd      = surface->dataPosition + size;
+    StrCopy(surface->fileName, "");
+    if (dataPosEnd < gfxDataPosition) {
+        memmove(&graphicData[surface->dataPosition], &graphicData[dataPosEnd], gfxDataPosition - dataPosEnd);
+        *movedSize += gfxDataPosition - dataPosEnd;
+    }
+    *originalSize += GFXDATA_SIZE - dataPosEnd;
+
+    gfxDataPosition -= size;
+    for (int i = 0; i < SURFACE_COUNT; ++i) {
+        if (gfxSurface[i].dataPosition > surface->dataPosition)
+            gfxSurface[i].dataPosition -= size;
+    }
+}
+
+static void AddBenchmarkSheet(int sheetID, int width, int height, bool shifted)
+{
+    GFXSurface *surface = &gfxSurface[sheetID];
+    sprintf(surface->fileName, "Benchmark%d", sheetID);
+    surface->width  = width;
+    surface->height = height;
+    surface->depth  = 1;
+    if (shifted) {
+        surface->dataPosition = gfxDataPosition;
+        gfxDataPosition += width * height;
+        ReserveGraphicData(gfxDataPosition);
+    }
+    else {
+        AllocateSurfaceData(sheetID);
+    }
+    memset(&graphicData[surface->dataPosition], sheetID + 1, width * height);
+}
+
+static int CheckBenchmarkSheets()
+{
+    int mismatches = 0;
+    for (int i = 0; i < SURFACE_COUNT; ++i) {
+        GFXSurface *surface = &gfxSurface[i];
+        byte *gfxData       = &graphicData[surface->dataPosition];
+        for (int p = 0; StrLength(surface->fileName) > 0 && p < surface->width * surface->height; ++p) {
+            if (gfxData[p] != i + 1) {
+                ++mismatches;
+                break;
+            }
+        }
+    }
+    return mismatches;
+}
+
+void BenchmarkStageTransition()
+{
+    // loads a stage's worth of made up sheets, has a script swap a few of them mid stage, then clears them for the next stage like LoadStageFiles
+    // once by shifting the data after each removed sheet down & once by leaving gaps, only the removals are timed
+    const int passCount       = 16;
+    GFXSurface *savedSurfaces = new GFXSurface[SURFACE_COUNT];
+    SurfaceSpans *savedSpans  = new SurfaceSpans[SURFACE_COUNT];
+    int savedPosition         = gfxDataPosition;
+    byte *savedData           = new byte[savedPosition + 1];
+    double freq               = (double)SDL_GetPerformanceFrequency() / 1000.0;
+    memcpy(savedSurfaces, gfxSurface, sizeof(gfxSurface));
+    memcpy(savedSpans, surfaceSpans, sizeof(surfaceSpans));
+    memcpy(savedData, graphicData, savedPosition);
+    memset(gfxSurface, 0, sizeof(gfxSurface));
+    memset(surfaceSpans, 0, sizeof(surfaceSpans));
+    gfxDataPosition  = 0;
+    firstFreeSurface = 0;
+
+    double time[2]         = { 0.0, 0.0 };
+    double defragmentTime  = 0.0;
+    long long movedSize    = 0;
+    long long originalSize = 0;
+    int mismatches         = 0;
+    for (int k = 0; k < 2; ++k) {
+        bool shifted = k == 0;
+        uint seed    = 0x5EED;
+        for (int p = 0; p < passCount; ++p) {
+            for (int s = 0; s < BENCHMARK_STAGE_SHEETS; ++s) {
+                seed       = seed * 1103515245 + 12345;
+                int width  = 0x40 << ((seed >> 16) & 3);
+                int height = 0x40 << ((seed >> 20) & 3);
+                AddBenchmarkSheet(s, width, height, shifted);
+            }
+
+            unsigned long long start = SDL_GetPerformanceCounter();
+            for (int s = 0; s < BENCHMARK_STAGE_SHEETS; s += 6) {
+                if (shifted)
+                    ShiftOutSurface(s, &movedSize, &originalSize);
+                else
+                    RemoveGraphicsFile("", s);
+            }
+            time[k] += SDL_GetPerformanceCounter() - start;
+
+            for (int s = 0; s < BENCHMARK_STAGE_SHEETS; s += 6) AddBenchmarkSheet(s, 0x40, 0x80, shifted);
+            mismatches += CheckBenchmarkSheets();
+            if (!shifted && p == passCount - 1) {
+                start = SDL_GetPerformanceCounter();
+                DefragmentGraphicData();
+                defragmentTime = (SDL_GetPerformanceCounter() - start) / freq;
+                mismatches += CheckBenchmarkSheets();
+            }
+
+            start = SDL_GetPerformanceCounter();
+            for (int i = SURFACE_COUNT; i > 0; --i) {
+                if (!StrLength(gfxSurface[i - 1].fileName))
+                    continue;
+                if (shifted)
+                    ShiftOutSurface(i - 1, &movedSize, &originalSize);
+                else
+                    RemoveGraphicsFile("", i - 1);
+            }
+            time[k] += SDL_GetPerformanceCounter() - start;
+            if (gfxDataPosition)
+                ++mismatches;
+        }
+        time[k] /= freq * passCount;
+    }
+
+    PrintLog("Stage transition benchmark: %d sheets, shifting %.4fms (%lld KB moved, the original loop copied %lld MB), gaps %.4fms (%.2fx)",
+             BENCHMARK_STAGE_SHEETS, time[0], movedSize / passCount / 1024, originalSize / passCount >> 20, time[1],
+             time[1] > 0.0 ? time[0] / time[1] : 0.0);
+    PrintLog("Stage transition benchmark: defragmenting took %.4fms, %d mismatched sheets", defragmentTime, mismatches);
+
+    memcpy(gfxSurface, savedSurfaces, sizeof(gfxSurface));
+    memcpy(surfaceSpans, savedSpans, sizeof(surfaceSpans));
+    memcpy(graphicData, savedData, savedPosition);
+    gfxDataPosition  = savedPosition;
+    firstFreeSurface = 0;
+    delete[] savedSurfaces;
+    delete[] savedSpans;
+    delete[] savedData;
+}
+#endif
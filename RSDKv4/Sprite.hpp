@@ -10,4 +10,16 @@ int LoadPVRFile(const char *filePath, byte sheetID);
 
 void ReadGifPictureData(int width, int height, bool interlaced, byte *gfxData, int offset);
 
+#if !RETRO_USE_ORIGINAL_CODE
+bool AllocateSurfaceData(int sheetID);
+void DefragmentGraphicData();
+
+void DemoteGraphicsFile(int sheetID);
+void ReportSheetCache();
+void ReportGifDecoding();
+void ReleaseSheetCache();
+
+void BenchmarkStageTransition();
+#endif
+
 #endif // !SPRITE_H
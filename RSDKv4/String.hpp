@@ -139,6 +139,17 @@ inline int StrLength(const char *string)
     return len;
 #endif
 }
+#if !RETRO_USE_ORIGINAL_CODE
+// StrComp treats characters 0x20 apart as the same (not just letters), so only the low 5 bits of each go in
+// anything StrComp would match hashes the same, barring its habit of matching a terminator against a space
+inline uint StrHash(const char *string)
+{
+    uint hash = 0x811C9DC5;
+    while (*string) hash = (hash ^ (*string++ & 0x1F)) * 0x01000193;
+    return hash;
+}
+#endif
+
 int FindStringToken(const char *string, const char *token, char stopID);
 int FindLastStringToken(const char *string, const char *token);
 
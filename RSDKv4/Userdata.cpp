@@ -260,6 +260,12 @@ void InitUserdata()
         Engine.startStage_Game = Engine.startStage;
 
         ini.SetBool("Dev", "UseHQModes", Engine.useHQModes = true);
+        ini.SetBool("Dev", "UseSIMD", Engine.useSIMD = true);
+        ini.SetBool("Dev", "UseTileCache", Engine.useTileCache = false);
+        ini.SetBool("Dev", "UseLayerOcclusion", Engine.useLayerOcclusion = false);
+        ini.SetBool("Dev", "UseSpriteSpans", Engine.useSpriteSpans = false);
+        ini.SetInteger("Dev", "SheetCacheSize", Engine.sheetCacheSize = 0x4000);
+        ini.SetBool("Dev", "BakeSheets", Engine.bakeSheets = false);
         ini.SetString("Dev", "DataFile", (char *)"Data.rsdk");
 		
         StrCopy(Engine.dataFile[0], "Data.rsdk");
@@ -407,6 +413,18 @@ void InitUserdata()
             Engine.fastForwardSpeed = 8;
         if (!ini.GetBool("Dev", "UseHQModes", &Engine.useHQModes))
             Engine.useHQModes = true;
+        if (!ini.GetBool("Dev", "UseSIMD", &Engine.useSIMD))
+            Engine.useSIMD = true;
+        if (!ini.GetBool("Dev", "UseTileCache", &Engine.useTileCache))
+            Engine.useTileCache = false;
+        if (!ini.GetBool("Dev", "UseLayerOcclusion", &Engine.useLayerOcclusion))
+            Engine.useLayerOcclusion = false;
+        if (!ini.GetBool("Dev", "UseSpriteSpans", &Engine.useSpriteSpans))
+            Engine.useSpriteSpans = false;
+        if (!ini.GetInteger("Dev", "SheetCacheSize", &Engine.sheetCacheSize))
+            Engine.sheetCacheSize = 0x4000;
+        if (!ini.GetBool("Dev", "BakeSheets", &Engine.bakeSheets))
+            Engine.bakeSheets = false;
 
         Engine.startList_Game  = Engine.startList;
         Engine.startStage_Game = Engine.startStage;
@@ -695,6 +713,23 @@ void WriteSettings()
         "Dev", "UseHQComment",
         "Determines if applicable rendering modes (such as 3D floor from special stages) will render in \"High Quality\" mode or standard mode");
     ini.SetBool("Dev", "UseHQModes", Engine.useHQModes);
+    ini.SetComment("Dev", "UseSIMDComment", "Determines if the software renderer will use the SIMD versions of its blending routines (if supported)");
+    ini.SetBool("Dev", "UseSIMD", Engine.useSIMD);
+    ini.SetComment("Dev", "UseTileCacheComment",
+                   "Enable this flag to keep stage tiles pre-converted to screen colours, trading memory for faster tile layer drawing");
+    ini.SetBool("Dev", "UseTileCache", Engine.useTileCache);
+    ini.SetComment("Dev", "UseLayerOcclusionComment",
+                   "Enable this flag to skip drawing tile layer pixels that are fully covered by tile layers drawn above them");
+    ini.SetBool("Dev", "UseLayerOcclusion", Engine.useLayerOcclusion);
+    ini.SetComment("Dev", "UseSpriteSpansComment",
+                   "Enable this flag to index the transparent parts of sprite sheets when they load, so sprites can skip over them when drawn");
+    ini.SetBool("Dev", "UseSpriteSpans", Engine.useSpriteSpans);
+    ini.SetComment("Dev", "SheetCacheSizeComment",
+                   "KB of decoded sprite sheets kept between stages, so the next stage can skip decoding the ones it shares (0 to disable)");
+    ini.SetInteger("Dev", "SheetCacheSize", Engine.sheetCacheSize);
+    ini.SetComment("Dev", "BakeSheetsComment",
+                   "Enable this flag to read sprite sheets from the Baked folder (if it exists) instead of decoding them, and to bake new ones");
+    ini.SetBool("Dev", "BakeSheets", Engine.bakeSheets);
 
     ini.SetComment("Dev", "DataFileComment", "Determines where the first RSDK file will be loaded from");
     ini.SetString("Dev", "DataFile", Engine.dataFile[0]);
@@ -172,6 +172,7 @@ void UpdateVideoFrame()
                 activePalette32[i].b = clr[2];
                 activePalette[i]     = ((ushort)(clr[0] >> 3) << 11) | 32 * (clr[1] >> 2) | (clr[2] >> 3);
             }
+            ++paletteGeneration[ACTIVE_PALETTE_ID];
 
             FileRead(&fileBuffer, 1);
             while (fileBuffer != ',') FileRead(&fileBuffer, 1); // gif image start identifier
@@ -192,6 +193,10 @@ void UpdateVideoFrame()
                 } while (c != 0x100);
             }
             ReadGifPictureData(surface->width, surface->height, interlaced, graphicData, surface->dataPosition);
+#if !RETRO_USE_ORIGINAL_CODE
+            // the frame replaces the surface's pixels, so its spans are out of date
+            ReleaseSurfaceSpans(videoSurface);
+#endif
 
             SetFilePosition(videoFilePos);
             ++currentVideoFrame;
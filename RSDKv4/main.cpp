@@ -44,6 +44,16 @@ void parseArguments(int argc, char *argv[])
         if (find) {
             usingCWD = true;
         }
+
+        find = strstr(argv[a], "renderThreads=");
+        if (find) {
+            Engine.renderThreads = atoi(&find[14]);
+        }
+
+        find = strstr(argv[a], "benchmark=true");
+        if (find) {
+            Engine.runBenchmarks = true;
+        }
     }
 }
 #endif